@@ -393,5 +393,32 @@
         }],  # OS=="win"
       ],
     },
+    {
+      # Measures the cost of the network emulation, see the file for usage.
+      'target_name': 'devtools_network_benchmark',
+      'type': 'executable',
+      'dependencies': [
+        'brightray',
+      ],
+      'sources': [
+        'browser/net/devtools_network_benchmark.cc',
+      ],
+    },
+    {
+      'target_name': 'brightray_unittests',
+      'type': 'executable',
+      'dependencies': [
+        'brightray',
+      ],
+      'include_dirs': [
+        '<(libchromiumcontent_src_dir)/third_party/googletest/src/googletest',
+        '<(libchromiumcontent_src_dir)/third_party/googletest/src/googletest/include',
+      ],
+      'sources': [
+        '<@(brightray_unittest_sources)',
+        '<(libchromiumcontent_src_dir)/third_party/googletest/src/googletest/src/gtest-all.cc',
+        '<(libchromiumcontent_src_dir)/third_party/googletest/src/googletest/src/gtest_main.cc',
+      ],
+    },
   ],
 }
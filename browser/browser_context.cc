@@ -8,12 +8,18 @@
 #include "browser/brightray_paths.h"
 #include "browser/browser_client.h"
 #include "browser/inspectable_web_contents_impl.h"
+#include "browser/net/host_cache_persister.h"
+#include "browser/net/http_server_properties_pref_delegate.h"
+#include "browser/net/network_usage_tracker.h"
+#include "browser/net/preconnect_manager.h"
+#include "browser/net/request_latency_tracker.h"
 #include "browser/network_delegate.h"
 #include "browser/permission_manager.h"
 #include "browser/special_storage_policy.h"
 #include "browser/zoom_level_delegate.h"
 #include "common/application_info.h"
 
+#include "base/bind.h"
 #include "base/files/file_path.h"
 #include "base/path_service.h"
 
@@ -27,6 +33,7 @@
 #include "content/public/browser/resource_context.h"
 #include "content/public/browser/storage_partition.h"
 #include "net/base/escape.h"
+#include "net/http/http_server_properties_manager.h"
 
 using content::BrowserThread;
 
@@ -83,8 +90,15 @@ scoped_refptr<BrowserContext> BrowserContext::Get(
 
 BrowserContext::BrowserContext(const std::string& partition, bool in_memory)
     : in_memory_(in_memory),
+      max_learned_preconnect_origins_(0),
+      share_socket_pools_(false),
       resource_context_(new ResourceContext),
       storage_policy_(new SpecialStoragePolicy),
+      network_usage_tracker_(new NetworkUsageTracker),
+      request_latency_tracker_(new RequestLatencyTracker),
+      http_server_properties_manager_(nullptr),
+      host_cache_persister_(nullptr),
+      preconnect_manager_(nullptr),
       weak_factory_(this) {
   if (!PathService::Get(DIR_USER_DATA, &path_)) {
     PathService::Get(DIR_APP_DATA, &path_);
@@ -103,6 +117,12 @@ BrowserContext::BrowserContext(const std::string& partition, bool in_memory)
 }
 
 BrowserContext::~BrowserContext() {
+  if (http_server_properties_manager_)
+    http_server_properties_manager_->ShutdownOnPrefThread();
+  if (host_cache_persister_)
+    host_cache_persister_->ShutdownOnUIThread();
+  if (preconnect_manager_)
+    preconnect_manager_->ShutdownOnUIThread();
   NotifyWillBeDestroyed(this);
   ShutdownStoragePartitions();
   BrowserThread::DeleteSoon(BrowserThread::IO,
@@ -126,6 +146,9 @@ void BrowserContext::InitPrefs() {
 
 void BrowserContext::RegisterInternalPrefs(PrefRegistrySimple* registry) {
   InspectableWebContentsImpl::RegisterPrefs(registry);
+  HostCachePersister::RegisterPrefs(registry);
+  HttpServerPropertiesPrefDelegate::RegisterPrefs(registry);
+  PreconnectManager::RegisterPrefs(registry);
   MediaDeviceIDSalt::RegisterPrefs(registry);
   ZoomLevelDelegate::RegisterPrefs(registry);
 }
@@ -149,12 +172,89 @@ net::URLRequestContextGetter* BrowserContext::CreateRequestContext(
       BrowserThread::GetTaskRunnerForThread(BrowserThread::FILE),
       protocol_handlers,
       std::move(protocol_interceptors));
+  url_request_getter_->StartParsingCTLogs();
   resource_context_->set_url_request_context_getter(url_request_getter_.get());
   return url_request_getter_.get();
 }
 
+void BrowserContext::PrefetchDNS(const std::vector<std::string>& hosts) {
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&URLRequestContextGetter::PrefetchDNS,
+                 make_scoped_refptr(GetRequestContext()), hosts));
+}
+
+void BrowserContext::ShareNetworkSession(BrowserContext* owner,
+                                         bool share_socket_pools) {
+  DCHECK(!url_request_getter_.get());
+  DCHECK_NE(owner, this);
+  if (owner->IsOffTheRecord() != IsOffTheRecord()) {
+    LOG(ERROR) << "Can not share a network session between an in-memory "
+                  "and a persistent partition";
+    return;
+  }
+  network_session_owner_ = owner;
+  share_socket_pools_ = share_socket_pools;
+}
+
+void BrowserContext::Preconnect(const GURL& url, int num_sockets) {
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&URLRequestContextGetter::Preconnect,
+                 make_scoped_refptr(GetRequestContext()), url, num_sockets));
+}
+
 net::NetworkDelegate* BrowserContext::CreateNetworkDelegate() {
-  return new NetworkDelegate;
+  return new NetworkDelegate(network_usage_tracker_, request_latency_tracker_);
+}
+
+URLRequestContextGetter::HttpCacheOptions
+BrowserContext::GetHttpCacheOptions() {
+  return http_cache_options_;
+}
+
+std::unique_ptr<net::HttpServerPropertiesManager>
+BrowserContext::CreateHttpServerPropertiesManager() {
+  // Off the record partitions forget what they learned.
+  if (IsOffTheRecord() || !prefs_)
+    return nullptr;
+  std::unique_ptr<net::HttpServerPropertiesManager> manager(
+      new net::HttpServerPropertiesManager(
+          new HttpServerPropertiesPrefDelegate(prefs_.get()),
+          BrowserThread::GetTaskRunnerForThread(BrowserThread::UI),
+          BrowserThread::GetTaskRunnerForThread(BrowserThread::IO)));
+  http_server_properties_manager_ = manager.get();
+  return manager;
+}
+
+std::unique_ptr<HostCachePersister>
+BrowserContext::CreateHostCachePersister() {
+  if (IsOffTheRecord() || !prefs_)
+    return nullptr;
+  std::unique_ptr<HostCachePersister> persister(
+      new HostCachePersister(prefs_.get()));
+  host_cache_persister_ = persister.get();
+  return persister;
+}
+
+std::unique_ptr<PreconnectManager> BrowserContext::CreatePreconnectManager() {
+  PrefService* pref_service =
+      IsOffTheRecord() || max_learned_preconnect_origins_ == 0 ?
+          nullptr : prefs_.get();
+  std::unique_ptr<PreconnectManager> manager(
+      new PreconnectManager(pref_service, max_learned_preconnect_origins_));
+  preconnect_manager_ = manager.get();
+  return manager;
+}
+
+URLRequestContextGetter::SharedNetworkSession
+BrowserContext::GetSharedNetworkSession() {
+  URLRequestContextGetter::SharedNetworkSession shared_session;
+  if (network_session_owner_) {
+    shared_session.owner = network_session_owner_->GetRequestContext();
+    shared_session.share_socket_pools = share_socket_pools_;
+  }
+  return shared_session;
 }
 
 MediaDeviceIDSalt* BrowserContext::GetMediaDeviceIDSalt() {
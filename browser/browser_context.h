@@ -6,6 +6,8 @@
 #define BRIGHTRAY_BROWSER_BROWSER_CONTEXT_H_
 
 #include <map>
+#include <string>
+#include <vector>
 
 #include "browser/net/devtools_network_controller_handle.h"
 #include "browser/permission_manager.h"
@@ -15,6 +17,7 @@
 #include "base/memory/weak_ptr.h"
 #include "content/public/browser/browser_context.h"
 
+class GURL;
 class PrefRegistrySimple;
 class PrefService;
 
@@ -25,6 +28,8 @@ class SpecialStoragePolicy;
 namespace brightray {
 
 class MediaDeviceIDSalt;
+class NetworkUsageTracker;
+class RequestLatencyTracker;
 class PermissionManager;
 
 class BrowserContext : public base::RefCounted<BrowserContext>,
@@ -72,6 +77,16 @@ class BrowserContext : public base::RefCounted<BrowserContext>,
     return url_request_getter_.get();
   }
 
+  // Called on the UI thread, the bytes sent and received by the partition.
+  NetworkUsageTracker* network_usage_tracker() const {
+    return network_usage_tracker_.get();
+  }
+
+  // Called on the UI thread, the latency of the requests of the partition.
+  RequestLatencyTracker* request_latency_tracker() const {
+    return request_latency_tracker_.get();
+  }
+
   DevToolsNetworkControllerHandle* network_controller_handle() {
     return &network_controller_handle_;
   }
@@ -79,6 +94,35 @@ class BrowserContext : public base::RefCounted<BrowserContext>,
   void InitPrefs();
   PrefService* prefs() { return prefs_.get(); }
 
+  // Resolves |hosts| ahead of the requests to them.
+  void PrefetchDNS(const std::vector<std::string>& hosts);
+
+  // Opens |num_sockets| connections to the origin of |url| ahead of the
+  // requests to it.
+  void Preconnect(const GURL& url, int num_sockets);
+
+  // Must be called before the request context is created.
+  void set_http_cache_options(
+      const URLRequestContextGetter::HttpCacheOptions& options) {
+    http_cache_options_ = options;
+  }
+
+  // Uses the host resolver and certificate verifier of |owner|, and with
+  // |share_socket_pools| its whole network session. Cookies and the HTTP
+  // cache stay separate, but the session also holds the HTTP auth cache,
+  // channel IDs and server properties: only share it between partitions of
+  // the same user. Sharing between an in-memory and a persistent partition
+  // is refused, the lookups and credentials of the former would outlive it.
+  // Must be called before the request context is created.
+  void ShareNetworkSession(BrowserContext* owner, bool share_socket_pools);
+
+  // Learns the |max_origins| origins most used by a session and preconnects
+  // to them on the next run. Must be called before the request context is
+  // created, off the record partitions never learn.
+  void set_max_learned_preconnect_origins(size_t max_origins) {
+    max_learned_preconnect_origins_ = max_origins;
+  }
+
  protected:
   BrowserContext(const std::string& partition, bool in_memory);
   ~BrowserContext() override;
@@ -88,6 +132,13 @@ class BrowserContext : public base::RefCounted<BrowserContext>,
 
   // URLRequestContextGetter::Delegate:
   net::NetworkDelegate* CreateNetworkDelegate() override;
+  URLRequestContextGetter::HttpCacheOptions GetHttpCacheOptions() override;
+  std::unique_ptr<net::HttpServerPropertiesManager>
+  CreateHttpServerPropertiesManager() override;
+  std::unique_ptr<HostCachePersister> CreateHostCachePersister() override;
+  std::unique_ptr<PreconnectManager> CreatePreconnectManager() override;
+  URLRequestContextGetter::SharedNetworkSession GetSharedNetworkSession()
+      override;
   MediaDeviceIDSalt* GetMediaDeviceIDSalt() override;
 
   base::FilePath GetPath() const override;
@@ -122,15 +173,25 @@ class BrowserContext : public base::RefCounted<BrowserContext>,
 
   base::FilePath path_;
   bool in_memory_;
+  URLRequestContextGetter::HttpCacheOptions http_cache_options_;
+  size_t max_learned_preconnect_origins_;
+  scoped_refptr<BrowserContext> network_session_owner_;
+  bool share_socket_pools_;
 
   DevToolsNetworkControllerHandle network_controller_handle_;
 
   std::unique_ptr<ResourceContext> resource_context_;
   scoped_refptr<URLRequestContextGetter> url_request_getter_;
   scoped_refptr<storage::SpecialStoragePolicy> storage_policy_;
+  scoped_refptr<NetworkUsageTracker> network_usage_tracker_;
+  scoped_refptr<RequestLatencyTracker> request_latency_tracker_;
   std::unique_ptr<PrefService> prefs_;
   std::unique_ptr<PermissionManager> permission_manager_;
   std::unique_ptr<MediaDeviceIDSalt> media_device_id_salt_;
+  // Owned by the request context on the IO thread.
+  net::HttpServerPropertiesManager* http_server_properties_manager_;
+  HostCachePersister* host_cache_persister_;
+  PreconnectManager* preconnect_manager_;
 
   base::WeakPtrFactory<BrowserContext> weak_factory_;
 
@@ -0,0 +1,383 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+// Drives a DevToolsNetworkInterceptor with synthetic transactions in virtual
+// time and reports the CPU time it costs per emulated second.
+//
+//   devtools_network_benchmark [--duration=<seconds>] [--seed=<n>]
+//                              [--transactions=<n>,<n>,...]
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/macros.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "browser/net/devtools_network_conditions.h"
+#include "browser/net/devtools_network_interceptor.h"
+#include "browser/net/devtools_network_virtual_time.h"
+#include "net/base/net_errors.h"
+
+namespace brightray {
+
+namespace {
+
+const char kDuration[] = "duration";
+const char kSeed[] = "seed";
+const char kTransactions[] = "transactions";
+
+const int kDefaultTransactions[] = { 1, 10, 100, 1000, 10000 };
+const int kDefaultDuration = 10;
+
+// Size of the chunks read or sent by a transaction.
+const int kChunkSize = 16 * 1024;
+const int kMaxChunks = 64;
+
+// One transaction in four is an upload.
+const int kUploadRatio = 4;
+// Every that many callbacks a random transaction is cancelled and restarted.
+const int kCancelInterval = 16;
+
+int64_t CpuMicroseconds() {
+  if (base::ThreadTicks::IsSupported())
+    return (base::ThreadTicks::Now() - base::ThreadTicks()).InMicroseconds();
+  return (base::TimeTicks::Now() - base::TimeTicks()).InMicroseconds();
+}
+
+struct Scenario {
+  int transactions;
+  bool latency;
+};
+
+struct Result {
+  Result()
+      : callbacks(0),
+        firings(0),
+        start_calls(0),
+        stop_calls(0),
+        total_us(0),
+        start_us(0),
+        stop_us(0) {}
+
+  int64_t callbacks;
+  // Distinct virtual times at which callbacks ran, one per timer firing.
+  int64_t firings;
+  int64_t start_calls;
+  int64_t stop_calls;
+  int64_t total_us;
+  int64_t start_us;
+  int64_t stop_us;
+};
+
+class Benchmark;
+
+class SyntheticTransaction {
+ public:
+  SyntheticTransaction(Benchmark* benchmark, uint64_t id, bool is_upload);
+
+  void Start();
+  void Cancel();
+
+  bool finished() const { return finished_; }
+
+ private:
+  void ReadChunk(bool start);
+  void OnThrottled(int result, int64_t bytes);
+
+  Benchmark* benchmark_;
+  const uint64_t id_;
+  const bool is_upload_;
+  DevToolsNetworkInterceptor::ThrottleCallback callback_;
+  DevToolsNetworkInterceptor::ThrottleHandle handle_;
+  int64_t throttled_bytes_;
+  int chunks_left_;
+  bool pending_;
+  bool finished_;
+
+  DISALLOW_COPY_AND_ASSIGN(SyntheticTransaction);
+};
+
+class Benchmark {
+ public:
+  Benchmark(const Scenario& scenario, base::TimeDelta duration, uint32_t seed);
+
+  Result Run();
+
+  int NextChunkCount() { return 1 + random_() % kMaxChunks; }
+  bool IsOver() const;
+  int StartThrottle(int result,
+                    int64_t bytes,
+                    bool start,
+                    bool is_upload,
+                    uint64_t id,
+                    const DevToolsNetworkInterceptor::ThrottleCallback& cb,
+                    DevToolsNetworkInterceptor::ThrottleHandle* handle);
+  void StopThrottle(DevToolsNetworkInterceptor::ThrottleHandle handle);
+  void OnCallback();
+
+ private:
+  const Scenario scenario_;
+  const base::TimeDelta duration_;
+  std::minstd_rand random_;
+
+  scoped_refptr<DevToolsNetworkVirtualTime> virtual_time_;
+  std::unique_ptr<DevToolsNetworkInterceptor> interceptor_;
+  std::vector<std::unique_ptr<SyntheticTransaction>> transactions_;
+  base::TimeTicks end_time_;
+  base::TimeTicks last_callback_time_;
+  Result result_;
+
+  DISALLOW_COPY_AND_ASSIGN(Benchmark);
+};
+
+SyntheticTransaction::SyntheticTransaction(Benchmark* benchmark,
+                                           uint64_t id,
+                                           bool is_upload)
+    : benchmark_(benchmark),
+      id_(id),
+      is_upload_(is_upload),
+      callback_(base::Bind(&SyntheticTransaction::OnThrottled,
+                           base::Unretained(this))),
+      handle_(DevToolsNetworkInterceptor::kInvalidThrottleHandle),
+      throttled_bytes_(0),
+      chunks_left_(0),
+      pending_(false),
+      finished_(false) {
+}
+
+void SyntheticTransaction::Start() {
+  throttled_bytes_ = 0;
+  chunks_left_ = benchmark_->NextChunkCount();
+  ReadChunk(true);
+}
+
+void SyntheticTransaction::Cancel() {
+  if (!pending_)
+    return;
+  benchmark_->StopThrottle(handle_);
+  pending_ = false;
+  Start();
+}
+
+void SyntheticTransaction::ReadChunk(bool start) {
+  // Transactions stop once the emulated duration is over, which drains the
+  // interceptor.
+  if (benchmark_->IsOver()) {
+    finished_ = true;
+    return;
+  }
+
+  // Uploads never pay the latency, as in DevToolsNetworkUploadDataStream.
+  throttled_bytes_ += kChunkSize;
+  int rv = benchmark_->StartThrottle(kChunkSize, throttled_bytes_,
+                                     start && !is_upload_, is_upload_, id_,
+                                     callback_, &handle_);
+  if (rv == net::ERR_IO_PENDING) {
+    pending_ = true;
+    return;
+  }
+  // Unthrottled, go on without reentering.
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE,
+      base::Bind(&SyntheticTransaction::OnThrottled, base::Unretained(this),
+                 rv, throttled_bytes_));
+}
+
+void SyntheticTransaction::OnThrottled(int result, int64_t bytes) {
+  pending_ = false;
+  throttled_bytes_ = bytes;
+  benchmark_->OnCallback();
+  if (--chunks_left_ > 0)
+    ReadChunk(false);
+  else
+    Start();
+}
+
+Benchmark::Benchmark(const Scenario& scenario,
+                     base::TimeDelta duration,
+                     uint32_t seed)
+    : scenario_(scenario),
+      duration_(duration),
+      random_(seed) {
+}
+
+Result Benchmark::Run() {
+  virtual_time_ =
+      new DevToolsNetworkVirtualTime(base::ThreadTaskRunnerHandle::Get());
+  interceptor_.reset(
+      new DevToolsNetworkInterceptor(virtual_time_->clock(), virtual_time_));
+
+  // A fast link, so that every transaction gets some of the bandwidth.
+  std::unique_ptr<DevToolsNetworkConditions> conditions(
+      new DevToolsNetworkConditions(false,
+                                    scenario_.latency ? 100 : 0,
+                                    100 * 1024 * 1024,
+                                    20 * 1024 * 1024));
+  interceptor_->UpdateConditions(std::move(conditions));
+
+  for (int i = 0; i < scenario_.transactions; ++i) {
+    bool is_upload = i % kUploadRatio == kUploadRatio - 1;
+    transactions_.push_back(std::unique_ptr<SyntheticTransaction>(
+        new SyntheticTransaction(this, i + 1, is_upload)));
+  }
+
+  end_time_ = virtual_time_->clock()->NowTicks() + duration_;
+  int64_t cpu_start = CpuMicroseconds();
+  for (const auto& transaction : transactions_)
+    transaction->Start();
+  base::RunLoop().RunUntilIdle();
+  result_.total_us = CpuMicroseconds() - cpu_start;
+
+  interceptor_.reset();
+  transactions_.clear();
+  return result_;
+}
+
+bool Benchmark::IsOver() const {
+  return virtual_time_->clock()->NowTicks() >= end_time_;
+}
+
+int Benchmark::StartThrottle(
+    int result,
+    int64_t bytes,
+    bool start,
+    bool is_upload,
+    uint64_t id,
+    const DevToolsNetworkInterceptor::ThrottleCallback& callback,
+    DevToolsNetworkInterceptor::ThrottleHandle* handle) {
+  base::TimeTicks send_end;
+  if (start)
+    send_end = virtual_time_->clock()->NowTicks();
+  int64_t cpu_start = CpuMicroseconds();
+  int rv = interceptor_->StartThrottle(
+      result, bytes, send_end, start, is_upload, id,
+      DevToolsNetworkInterceptor::Connection(), callback, handle);
+  result_.start_us += CpuMicroseconds() - cpu_start;
+  ++result_.start_calls;
+  return rv;
+}
+
+void Benchmark::StopThrottle(
+    DevToolsNetworkInterceptor::ThrottleHandle handle) {
+  int64_t cpu_start = CpuMicroseconds();
+  interceptor_->StopThrottle(handle);
+  result_.stop_us += CpuMicroseconds() - cpu_start;
+  ++result_.stop_calls;
+}
+
+void Benchmark::OnCallback() {
+  base::TimeTicks now = virtual_time_->clock()->NowTicks();
+  if (now != last_callback_time_) {
+    last_callback_time_ = now;
+    ++result_.firings;
+  }
+  ++result_.callbacks;
+
+  if (result_.callbacks % kCancelInterval == 0 && !IsOver()) {
+    SyntheticTransaction* victim =
+        transactions_[random_() % transactions_.size()].get();
+    if (!victim->finished())
+      victim->Cancel();
+  }
+}
+
+std::vector<int> ParseTransactions(const std::string& value) {
+  std::vector<int> counts;
+  for (const auto& piece : base::SplitString(
+           value, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    int count = 0;
+    if (base::StringToInt(piece, &count) && count > 0)
+      counts.push_back(count);
+  }
+  return counts;
+}
+
+int RunBenchmarks() {
+  const base::CommandLine* command_line =
+      base::CommandLine::ForCurrentProcess();
+
+  int duration = kDefaultDuration;
+  if (command_line->HasSwitch(kDuration) &&
+      (!base::StringToInt(command_line->GetSwitchValueASCII(kDuration),
+                          &duration) || duration <= 0)) {
+    fprintf(stderr, "Invalid --%s\n", kDuration);
+    return 1;
+  }
+
+  unsigned seed = 0;
+  if (command_line->HasSwitch(kSeed) &&
+      !base::StringToUint(command_line->GetSwitchValueASCII(kSeed), &seed)) {
+    fprintf(stderr, "Invalid --%s\n", kSeed);
+    return 1;
+  }
+
+  std::vector<int> counts(std::begin(kDefaultTransactions),
+                          std::end(kDefaultTransactions));
+  if (command_line->HasSwitch(kTransactions)) {
+    counts = ParseTransactions(
+        command_line->GetSwitchValueASCII(kTransactions));
+    if (counts.empty()) {
+      fprintf(stderr, "Invalid --%s\n", kTransactions);
+      return 1;
+    }
+  }
+
+  if (!base::ThreadTicks::IsSupported())
+    fprintf(stderr, "Thread CPU time unavailable, using wall time.\n");
+  printf("%12s %8s %14s %12s %12s %12s %14s %10s\n",
+         "transactions", "latency", "cpu ms/emul s", "start us", "stop us",
+         "timer us", "callbacks/s", "fan-out");
+
+  base::MessageLoop message_loop;
+  for (int count : counts) {
+    for (bool latency : { false, true }) {
+      Scenario scenario = { count, latency };
+      Benchmark benchmark(scenario, base::TimeDelta::FromSeconds(duration),
+                          seed);
+      Result result = benchmark.Run();
+
+      // Average cost of a single call, the timer is whatever is left.
+      double start_us = result.start_calls ?
+          double(result.start_us) / result.start_calls : 0;
+      double stop_us = result.stop_calls ?
+          double(result.stop_us) / result.stop_calls : 0;
+      int64_t timer_total_us =
+          result.total_us - result.start_us - result.stop_us;
+      double timer_us = result.firings ?
+          double(timer_total_us) / result.firings : 0;
+      double fan_out = result.firings ?
+          double(result.callbacks) / result.firings : 0;
+      printf("%12d %8s %14.3f %12.3f %12.3f %12.3f %14.1f %10.2f\n",
+             count, latency ? "100ms" : "none",
+             result.total_us / 1000.0 / duration, start_us, stop_us, timer_us,
+             double(result.callbacks) / duration, fan_out);
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+}  // namespace brightray
+
+int main(int argc, char* argv[]) {
+  base::AtExitManager at_exit;
+  base::CommandLine::Init(argc, argv);
+  if (base::ThreadTicks::IsSupported())
+    base::ThreadTicks::WaitUntilInitialized();
+  return brightray::RunBenchmarks();
+}
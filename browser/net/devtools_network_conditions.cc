@@ -4,13 +4,13 @@
 
 #include "browser/net/devtools_network_conditions.h"
 
+#include "browser/net/devtools_network_stats.h"
+#include "browser/net/devtools_network_trace.h"
+
 namespace brightray {
 
 DevToolsNetworkConditions::DevToolsNetworkConditions(bool offline)
-    : offline_(offline),
-      latency_(0),
-      download_throughput_(0),
-      upload_throughput_(0) {
+    : DevToolsNetworkConditions(offline, 0, 0, 0) {
 }
 
 DevToolsNetworkConditions::DevToolsNetworkConditions(
@@ -21,15 +21,39 @@ DevToolsNetworkConditions::DevToolsNetworkConditions(
     : offline_(offline),
       latency_(latency),
       download_throughput_(download_throughput),
-      upload_throughput_(upload_throughput) {
+      upload_throughput_(upload_throughput),
+      upload_latency_(0),
+      latency_jitter_(0),
+      jitter_distribution_(JITTER_UNIFORM),
+      packet_loss_(0),
+      retransmission_timeout_(0),
+      throughput_variance_(0),
+      throughput_variance_period_(0),
+      seed_(0),
+      trace_loop_(true),
+      initial_congestion_window_(0) {
 }
 
 DevToolsNetworkConditions::~DevToolsNetworkConditions() {
 }
 
+void DevToolsNetworkConditions::set_traces(
+    scoped_refptr<DevToolsNetworkTrace> download_trace,
+    scoped_refptr<DevToolsNetworkTrace> upload_trace,
+    bool loop) {
+  download_trace_ = std::move(download_trace);
+  upload_trace_ = std::move(upload_trace);
+  trace_loop_ = loop;
+}
+
+void DevToolsNetworkConditions::set_stats(
+    scoped_refptr<DevToolsNetworkStats> stats) {
+  stats_ = std::move(stats);
+}
+
 bool DevToolsNetworkConditions::IsThrottling() const {
   return !offline_ && ((latency_ != 0.0) || (download_throughput_ != 0.0) ||
-      (upload_throughput_ != 0.0));
+      (upload_throughput_ != 0.0) || download_trace_ || upload_trace_);
 }
 
 }  // namespace brightray
@@ -5,16 +5,28 @@
 #ifndef BROWSER_DEVTOOLS_NETWORK_CONDITIONS_H_
 #define BROWSER_DEVTOOLS_NETWORK_CONDITIONS_H_
 
+#include <stdint.h>
+
 #include <string>
 #include <vector>
 
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "url/gurl.h"
 
 namespace brightray {
 
+class DevToolsNetworkStats;
+class DevToolsNetworkTrace;
+
 class DevToolsNetworkConditions {
  public:
+  enum JitterDistribution {
+    JITTER_UNIFORM,
+    JITTER_NORMAL,
+    JITTER_PARETO,
+  };
+
   explicit DevToolsNetworkConditions(bool offline);
   DevToolsNetworkConditions(bool offline,
                             double latency,
@@ -24,17 +36,98 @@ class DevToolsNetworkConditions {
 
   bool IsThrottling() const;
 
+  // Optional variance model applied on top of the constant link. All of it is
+  // driven by a pseudo random generator seeded with |seed|, so the same
+  // conditions replay the same sequence of delays.
+
+  // Adds |jitter| milliseconds of noise to the latency of every response.
+  void set_latency_jitter(double jitter, JitterDistribution distribution) {
+    latency_jitter_ = jitter;
+    jitter_distribution_ = distribution;
+  }
+
+  // Drops every packet with |probability|, a dropped packet is sent again
+  // after |retransmission_timeout| milliseconds.
+  void set_packet_loss(double probability, double retransmission_timeout) {
+    packet_loss_ = probability;
+    retransmission_timeout_ = retransmission_timeout;
+  }
+
+  // Scales both throughputs by a random factor in [1 - variance, 1 + variance]
+  // picked again every |period| milliseconds.
+  void set_throughput_variance(double variance, double period) {
+    throughput_variance_ = variance;
+    throughput_variance_period_ = period;
+  }
+
+  void set_seed(uint64_t seed) { seed_ = seed; }
+
+  // Replaces the constant throughput of a direction with a recorded delivery
+  // schedule. A one-shot trace falls back to the constant throughput once it
+  // has been replayed. The variance model does not apply to traces.
+  void set_traces(scoped_refptr<DevToolsNetworkTrace> download_trace,
+                  scoped_refptr<DevToolsNetworkTrace> upload_trace,
+                  bool loop);
+
+  // Charges the handshake round trips of every new socket and limits each
+  // socket to a congestion window starting at |initial_congestion_window|
+  // packets that doubles every round trip. Zero disables the model.
+  void set_initial_congestion_window(int packets) {
+    initial_congestion_window_ = packets;
+  }
+
+  // Part of |latency| spent on the uplink, request bodies wait for it before
+  // being sent. Responses still pay the whole |latency|.
+  void set_upload_latency(double latency) { upload_latency_ = latency; }
+
+  // Statistics of the chunks throttled under these conditions.
+  void set_stats(scoped_refptr<DevToolsNetworkStats> stats);
+
   bool offline() const { return offline_; }
   double latency() const { return latency_; }
+  double upload_latency() const { return upload_latency_; }
   double download_throughput() const { return download_throughput_; }
   double upload_throughput() const { return upload_throughput_; }
 
+  double latency_jitter() const { return latency_jitter_; }
+  JitterDistribution jitter_distribution() const {
+    return jitter_distribution_;
+  }
+  double packet_loss() const { return packet_loss_; }
+  double retransmission_timeout() const { return retransmission_timeout_; }
+  double throughput_variance() const { return throughput_variance_; }
+  double throughput_variance_period() const {
+    return throughput_variance_period_;
+  }
+  uint64_t seed() const { return seed_; }
+  DevToolsNetworkTrace* download_trace() const {
+    return download_trace_.get();
+  }
+  DevToolsNetworkTrace* upload_trace() const { return upload_trace_.get(); }
+  bool trace_loop() const { return trace_loop_; }
+  int initial_congestion_window() const { return initial_congestion_window_; }
+  DevToolsNetworkStats* stats() const { return stats_.get(); }
+
  private:
   const bool offline_;
   const double latency_;
   const double download_throughput_;
   const double upload_throughput_;
 
+  double upload_latency_;
+  double latency_jitter_;
+  JitterDistribution jitter_distribution_;
+  double packet_loss_;
+  double retransmission_timeout_;
+  double throughput_variance_;
+  double throughput_variance_period_;
+  uint64_t seed_;
+  scoped_refptr<DevToolsNetworkTrace> download_trace_;
+  scoped_refptr<DevToolsNetworkTrace> upload_trace_;
+  bool trace_loop_;
+  int initial_congestion_window_;
+  scoped_refptr<DevToolsNetworkStats> stats_;
+
   DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkConditions);
 };
 
@@ -6,53 +6,207 @@
 
 #include "browser/net/devtools_network_conditions.h"
 #include "browser/net/devtools_network_interceptor.h"
+#include "browser/net/devtools_network_link.h"
+#include "browser/net/devtools_network_rules.h"
 #include "browser/net/devtools_network_transaction.h"
 
 #include "base/bind.h"
+#include "base/command_line.h"
+#include "base/lazy_instance.h"
+#include "browser/net/devtools_network_virtual_time.h"
+#include "common/switches.h"
 #include "content/public/browser/browser_thread.h"
 
 using content::BrowserThread;
 
 namespace brightray {
 
+namespace {
+
+// Shared by all the interceptors so they run on the same virtual clock.
+base::LazyInstance<scoped_refptr<DevToolsNetworkVirtualTime>>::Leaky
+    g_virtual_time = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+DevToolsNetworkController::Client::Client()
+    : offline(false) {
+}
+
+DevToolsNetworkController::Client::Client(Client&& other) = default;
+
+DevToolsNetworkController::Client::~Client() {
+}
+
+DevToolsNetworkController::Client&
+DevToolsNetworkController::Client::operator=(Client&& other) = default;
+
+bool DevToolsNetworkController::Client::IsEmpty() const {
+  return !interceptor && !link && !rules;
+}
+
 DevToolsNetworkController::DevToolsNetworkController()
-    : appcache_interceptor_(new DevToolsNetworkInterceptor) {
+    : appcache_interceptor_(CreateInterceptor()),
+      offline_count_(0),
+      offline_links_(0) {
+}
+
+// static
+std::unique_ptr<DevToolsNetworkInterceptor>
+DevToolsNetworkController::CreateInterceptor() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+
+  auto command_line = base::CommandLine::ForCurrentProcess();
+  if (!command_line->HasSwitch(switches::kDevToolsNetworkVirtualTime)) {
+    return std::unique_ptr<DevToolsNetworkInterceptor>(
+        new DevToolsNetworkInterceptor);
+  }
+
+  scoped_refptr<DevToolsNetworkVirtualTime>& virtual_time =
+      g_virtual_time.Get();
+  if (!virtual_time) {
+    virtual_time = new DevToolsNetworkVirtualTime(
+        BrowserThread::GetTaskRunnerForThread(BrowserThread::IO));
+  }
+  return std::unique_ptr<DevToolsNetworkInterceptor>(
+      new DevToolsNetworkInterceptor(virtual_time->clock(), virtual_time));
 }
 
 DevToolsNetworkController::~DevToolsNetworkController() {
+  for (const auto& link : links_)
+    link.first->RemoveController(this);
 }
 
 void DevToolsNetworkController::SetNetworkState(
     const std::string& client_id,
+    scoped_refptr<DevToolsNetworkLink> link,
     std::unique_ptr<DevToolsNetworkConditions> conditions) {
   DCHECK_CURRENTLY_ON(BrowserThread::IO);
 
-  auto it = interceptors_.find(client_id);
-  if (it == interceptors_.end()) {
-    if (!conditions)
-      return;
-    std::unique_ptr<DevToolsNetworkInterceptor> new_interceptor(
-        new DevToolsNetworkInterceptor);
-    new_interceptor->UpdateConditions(std::move(conditions));
-    interceptors_[client_id] = std::move(new_interceptor);
-  } else {
-    if (!conditions) {
-      std::unique_ptr<DevToolsNetworkConditions> online_conditions(
-          new DevToolsNetworkConditions(false));
-      it->second->UpdateConditions(std::move(online_conditions));
-      interceptors_.erase(client_id);
-    } else {
-      it->second->UpdateConditions(std::move(conditions));
+  if (!conditions) {
+    // The link keeps throttling the transactions already started on it.
+    Client* client = FindClient(client_id);
+    if (client) {
+      DetachLink(client);
+      RemoveInterceptor(client);
+      client->rules.reset();
+      ReleaseClient(client_id);
     }
+    UpdateAppCacheInterceptor();
+    return;
   }
 
-  bool has_offline_interceptors = false;
-  for (const auto& interceptor : interceptors_) {
-    if (interceptor.second->IsOffline()) {
-      has_offline_interceptors = true;
-      break;
-    }
+  Client* client = &clients_[InternClient(client_id)];
+  if (link) {
+    RemoveInterceptor(client);
+    AttachLink(client, link);
+    link->UpdateConditions(std::move(conditions));
+  } else {
+    DetachLink(client);
+    if (!client->interceptor)
+      client->interceptor = CreateInterceptor();
+    client->interceptor->UpdateConditions(std::move(conditions));
+    SetOffline(client, client->interceptor->IsOffline());
+  }
+
+  UpdateAppCacheInterceptor();
+}
+
+size_t DevToolsNetworkController::InternClient(const std::string& client_id) {
+  auto it = client_ids_.find(client_id);
+  if (it != client_ids_.end())
+    return it->second;
+
+  size_t index;
+  if (free_clients_.empty()) {
+    index = clients_.size();
+    clients_.push_back(Client());
+  } else {
+    index = free_clients_.back();
+    free_clients_.pop_back();
   }
+  client_ids_[client_id] = index;
+  return index;
+}
+
+DevToolsNetworkController::Client* DevToolsNetworkController::FindClient(
+    const std::string& client_id) {
+  auto it = client_ids_.find(client_id);
+  if (it == client_ids_.end())
+    return nullptr;
+  return &clients_[it->second];
+}
+
+void DevToolsNetworkController::ReleaseClient(const std::string& client_id) {
+  auto it = client_ids_.find(client_id);
+  if (it == client_ids_.end() || !clients_[it->second].IsEmpty())
+    return;
+
+  free_clients_.push_back(it->second);
+  client_ids_.erase(it);
+}
+
+void DevToolsNetworkController::RemoveInterceptor(Client* client) {
+  if (!client->interceptor)
+    return;
+
+  DevToolsNetworkInterceptor::DeleteWhenIdle(std::move(client->interceptor));
+  SetOffline(client, false);
+}
+
+void DevToolsNetworkController::AttachLink(
+    Client* client, scoped_refptr<DevToolsNetworkLink> link) {
+  if (client->link == link)
+    return;
+
+  DetachLink(client);
+  if (++links_[link.get()] == 1) {
+    link->AddController(this);
+    if (link->IsOffline())
+      ++offline_links_;
+  }
+  client->link = link;
+}
+
+void DevToolsNetworkController::DetachLink(Client* client) {
+  if (!client->link)
+    return;
+
+  auto it = links_.find(client->link.get());
+  DCHECK(it != links_.end());
+  if (--it->second == 0) {
+    links_.erase(it);
+    client->link->RemoveController(this);
+    if (client->link->IsOffline())
+      --offline_links_;
+  }
+  client->link = nullptr;
+}
+
+void DevToolsNetworkController::SetOffline(Client* client, bool offline) {
+  if (client->offline == offline)
+    return;
+
+  client->offline = offline;
+  if (offline)
+    ++offline_count_;
+  else
+    --offline_count_;
+}
+
+void DevToolsNetworkController::OnLinkOfflineChanged(bool offline) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+
+  // Links can also be updated by the clients of other browser contexts.
+  if (offline)
+    ++offline_links_;
+  else
+    --offline_links_;
+  UpdateAppCacheInterceptor();
+}
+
+void DevToolsNetworkController::UpdateAppCacheInterceptor() {
+  bool has_offline_interceptors = offline_count_ > 0 || offline_links_ > 0;
 
   bool is_appcache_offline = appcache_interceptor_->IsOffline();
   if (is_appcache_offline != has_offline_interceptors) {
@@ -62,18 +216,47 @@ void DevToolsNetworkController::SetNetworkState(
   }
 }
 
-DevToolsNetworkInterceptor*
-DevToolsNetworkController::GetInterceptor(const std::string& client_id) {
+void DevToolsNetworkController::SetRules(
+    const std::string& client_id,
+    std::unique_ptr<DevToolsNetworkRules> rules) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+
+  if (rules) {
+    clients_[InternClient(client_id)].rules = std::move(rules);
+    return;
+  }
+
+  Client* client = FindClient(client_id);
+  if (client) {
+    client->rules.reset();
+    ReleaseClient(client_id);
+  }
+}
+
+DevToolsNetworkInterceptor* DevToolsNetworkController::GetInterceptor(
+    const std::string& client_id,
+    const GURL& url,
+    int resource_type,
+    bool* blocked) {
   DCHECK_CURRENTLY_ON(BrowserThread::IO);
 
-  if (interceptors_.empty() || client_id.empty())
+  *blocked = false;
+  if (client_id.empty() || client_ids_.empty())
     return nullptr;
 
-  auto it = interceptors_.find(client_id);
-  if (it == interceptors_.end())
+  auto it = client_ids_.find(client_id);
+  if (it == client_ids_.end())
     return nullptr;
 
-  return it->second.get();
+  const Client& client = clients_[it->second];
+  DevToolsNetworkInterceptor* interceptor = nullptr;
+  if (client.rules &&
+      client.rules->Match(url, resource_type, blocked, &interceptor)) {
+    return interceptor;
+  }
+  if (client.link)
+    return client.link->GetInterceptor();
+  return client.interceptor.get();
 }
 
 }  // namespace brightray
@@ -8,14 +8,20 @@
 #include <unordered_map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "base/threading/thread_checker.h"
 
+class GURL;
+
 namespace brightray {
 
 class DevToolsNetworkConditions;
 class DevToolsNetworkInterceptor;
+class DevToolsNetworkLink;
+class DevToolsNetworkRules;
 class DevToolsNetworkTransaction;
 
 class DevToolsNetworkController {
@@ -23,18 +29,75 @@ class DevToolsNetworkController {
   DevToolsNetworkController();
   virtual ~DevToolsNetworkController();
 
+  // Called on the IO thread. Creates an interceptor running in virtual time
+  // when the --devtools-network-virtual-time switch is set.
+  static std::unique_ptr<DevToolsNetworkInterceptor> CreateInterceptor();
+
+  // When |link| is set the client shares it, and |conditions| apply to every
+  // client attached to the link.
   void SetNetworkState(const std::string& client_id,
+                       scoped_refptr<DevToolsNetworkLink> link,
                        std::unique_ptr<DevToolsNetworkConditions> conditions);
 
-  DevToolsNetworkInterceptor* GetInterceptor(const std::string& client_id);
+  // Rules take precedence over the conditions of the client, passing null
+  // |rules| removes them.
+  void SetRules(const std::string& client_id,
+                std::unique_ptr<DevToolsNetworkRules> rules);
+
+  // Returns the interceptor throttling a request of |client_id|, or nullptr.
+  // |resource_type| is a content::ResourceType or -1 when unknown, |blocked|
+  // is set when the request must not be sent.
+  DevToolsNetworkInterceptor* GetInterceptor(const std::string& client_id,
+                                             const GURL& url,
+                                             int resource_type,
+                                             bool* blocked);
+
+  // Called by an attached link when it goes offline or back online.
+  void OnLinkOfflineChanged(bool offline);
 
  private:
-  using InterceptorMap =
-      std::unordered_map<std::string,
-                         std::unique_ptr<DevToolsNetworkInterceptor>>;
+  // Emulation state of a client, kept in |clients_| at the index the client
+  // id was interned to.
+  struct Client {
+    Client();
+    Client(Client&& other);
+    ~Client();
+    Client& operator=(Client&& other);
+
+    bool IsEmpty() const;
+
+    std::unique_ptr<DevToolsNetworkInterceptor> interceptor;
+    scoped_refptr<DevToolsNetworkLink> link;
+    std::unique_ptr<DevToolsNetworkRules> rules;
+    // Whether |interceptor| is offline.
+    bool offline;
+  };
+
+  // Returns the index of |client_id|, interning it when it is new.
+  size_t InternClient(const std::string& client_id);
+  // Returns nullptr for clients without state.
+  Client* FindClient(const std::string& client_id);
+  // Frees the index of |client_id| once it has no state left.
+  void ReleaseClient(const std::string& client_id);
+
+  void RemoveInterceptor(Client* client);
+  void AttachLink(Client* client, scoped_refptr<DevToolsNetworkLink> link);
+  void DetachLink(Client* client);
+  void SetOffline(Client* client, bool offline);
+  void UpdateAppCacheInterceptor();
 
   std::unique_ptr<DevToolsNetworkInterceptor> appcache_interceptor_;
-  InterceptorMap interceptors_;
+
+  std::unordered_map<std::string, size_t> client_ids_;
+  std::vector<Client> clients_;
+  std::vector<size_t> free_clients_;
+
+  // Number of clients of this controller attached to each link.
+  std::unordered_map<DevToolsNetworkLink*, int> links_;
+  // Number of clients whose own interceptor is offline.
+  size_t offline_count_;
+  // Number of the links in |links_| which are offline.
+  size_t offline_links_;
 
   DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkController);
 };
@@ -7,6 +7,8 @@
 #include "base/bind.h"
 #include "browser/net/devtools_network_conditions.h"
 #include "browser/net/devtools_network_controller.h"
+#include "browser/net/devtools_network_link.h"
+#include "browser/net/devtools_network_rules.h"
 #include "content/public/browser/browser_thread.h"
 
 using content::BrowserThread;
@@ -25,13 +27,26 @@ DevToolsNetworkControllerHandle::~DevToolsNetworkControllerHandle() {
 
 void DevToolsNetworkControllerHandle::SetNetworkState(
     const std::string& client_id,
+    scoped_refptr<DevToolsNetworkLink> link,
     std::unique_ptr<DevToolsNetworkConditions> conditions) {
   DCHECK_CURRENTLY_ON(BrowserThread::UI);
 
   BrowserThread::PostTask(
       BrowserThread::IO, FROM_HERE,
       base::Bind(&DevToolsNetworkControllerHandle::SetNetworkStateOnIO,
-                 base::Unretained(this), client_id, base::Passed(&conditions)));
+                 base::Unretained(this), client_id, link,
+                 base::Passed(&conditions)));
+}
+
+void DevToolsNetworkControllerHandle::SetRules(
+    const std::string& client_id,
+    std::unique_ptr<DevToolsNetworkRules> rules) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  BrowserThread::PostTask(
+      BrowserThread::IO, FROM_HERE,
+      base::Bind(&DevToolsNetworkControllerHandle::SetRulesOnIO,
+                 base::Unretained(this), client_id, base::Passed(&rules)));
 }
 
 DevToolsNetworkController* DevToolsNetworkControllerHandle::GetController() {
@@ -50,11 +65,21 @@ void DevToolsNetworkControllerHandle::LazyInitialize() {
 
 void DevToolsNetworkControllerHandle::SetNetworkStateOnIO(
     const std::string& client_id,
+    scoped_refptr<DevToolsNetworkLink> link,
     std::unique_ptr<DevToolsNetworkConditions> conditions) {
   DCHECK_CURRENTLY_ON(BrowserThread::IO);
 
   LazyInitialize();
-  controller_->SetNetworkState(client_id, std::move(conditions));
+  controller_->SetNetworkState(client_id, link, std::move(conditions));
+}
+
+void DevToolsNetworkControllerHandle::SetRulesOnIO(
+    const std::string& client_id,
+    std::unique_ptr<DevToolsNetworkRules> rules) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+
+  LazyInitialize();
+  controller_->SetRules(client_id, std::move(rules));
 }
 
 }  // namespace brightray
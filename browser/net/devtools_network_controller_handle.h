@@ -9,11 +9,14 @@
 #include <string>
 
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 
 namespace brightray {
 
 class DevToolsNetworkConditions;
 class DevToolsNetworkController;
+class DevToolsNetworkLink;
+class DevToolsNetworkRules;
 
 // A handle to manage an IO-thread DevToolsNetworkController on the IO thread
 // while allowing SetNetworkState to be called from the UI thread.
@@ -24,7 +27,10 @@ class DevToolsNetworkControllerHandle {
 
   // Called on the UI thread.
   void SetNetworkState(const std::string& client_id,
+                       scoped_refptr<DevToolsNetworkLink> link,
                        std::unique_ptr<DevToolsNetworkConditions> conditions);
+  void SetRules(const std::string& client_id,
+                std::unique_ptr<DevToolsNetworkRules> rules);
 
   // Called on the IO thread.
   DevToolsNetworkController* GetController();
@@ -33,7 +39,10 @@ class DevToolsNetworkControllerHandle {
   void LazyInitialize();
   void SetNetworkStateOnIO(
       const std::string& client_id,
+      scoped_refptr<DevToolsNetworkLink> link,
       std::unique_ptr<DevToolsNetworkConditions> conditions);
+  void SetRulesOnIO(const std::string& client_id,
+                    std::unique_ptr<DevToolsNetworkRules> rules);
 
   std::unique_ptr<DevToolsNetworkController> controller_;
 
@@ -5,10 +5,18 @@
 #include "browser/net/devtools_network_interceptor.h"
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 
+#include "base/bind.h"
+#include "base/memory/ptr_util.h"
+#include "base/single_thread_task_runner.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/tick_clock.h"
 #include "base/time/time.h"
 #include "browser/net/devtools_network_conditions.h"
+#include "browser/net/devtools_network_stats.h"
+#include "browser/net/devtools_network_trace.h"
 #include "net/base/net_errors.h"
 
 namespace brightray {
@@ -17,6 +25,36 @@ namespace {
 
 int64_t kPacketSize = 1500;
 
+// Most callbacks run by a task, the remaining ones are left to another task
+// so that other work of the thread gets a turn.
+const size_t kMaxCallbacksPerTask = 32;
+
+// The connection model forgets the least recently active socket past this
+// count.
+const size_t kMaxSockets = 256;
+
+// Past this count of streams, the one whose last chunk is the oldest is
+// forgotten.
+const size_t kMaxStreams = 256;
+
+// Past this count of request bodies waiting for their response, the oldest
+// one is forgotten.
+const size_t kMaxUplinkPaidTransactions = 256;
+
+// TCP restarts slow start after an idle period of one retransmission timeout,
+// whose minimum is one second (RFC 5681).
+const int64_t kSlowStartRestartMicroseconds = 1000 * 1000;
+
+const double kPi = 3.14159265358979323846;
+
+// Shape of the pareto distribution used for heavy tailed jitter.
+const double kParetoShape = 2.5;
+
+// Maps a random 64-bit value onto [0, 1).
+double ToUnitInterval(uint64_t value) {
+  return (value >> 11) * (1.0 / 9007199254740992.0);
+}
+
 base::TimeDelta CalculateTickLength(double throughput) {
   if (!throughput)
     return base::TimeDelta();
@@ -29,6 +67,15 @@ base::TimeDelta CalculateTickLength(double throughput) {
 
 }  // namespace
 
+DevToolsNetworkInterceptor::Connection::Connection()
+    : socket_id(0),
+      is_new(false),
+      resolved_host(false),
+      secure(false),
+      streaming(false),
+      buffered(false) {
+}
+
 DevToolsNetworkInterceptor::ThrottleRecord::ThrottleRecord() {
 }
 
@@ -38,14 +85,70 @@ DevToolsNetworkInterceptor::ThrottleRecord::ThrottleRecord(
 DevToolsNetworkInterceptor::ThrottleRecord::~ThrottleRecord() {
 }
 
+DevToolsNetworkInterceptor::Slot::Slot()
+    : generation(1),
+      pending(false),
+      cancelled(false) {
+}
+
+DevToolsNetworkInterceptor::SocketState::SocketState()
+    : congestion_window(0) {
+}
+
 DevToolsNetworkInterceptor::DevToolsNetworkInterceptor()
+    : DevToolsNetworkInterceptor(nullptr,
+                                 base::ThreadTaskRunnerHandle::Get()) {
+}
+
+DevToolsNetworkInterceptor::DevToolsNetworkInterceptor(
+    base::TickClock* clock,
+    scoped_refptr<base::SingleThreadTaskRunner> task_runner)
     : conditions_(new DevToolsNetworkConditions(false)),
+      completions_scheduled_(false),
+      cancelled_count_(0),
+      clock_(clock),
+      task_runner_(task_runner),
       download_last_tick_(0),
       upload_last_tick_(0),
+      random_state_(0),
+      throughput_scale_(1.0),
+      timer_weak_factory_(this),
       weak_ptr_factory_(this) {
 }
 
 DevToolsNetworkInterceptor::~DevToolsNetworkInterceptor() {
+  // Release the transactions still queued, nothing would run their callbacks
+  // once the interceptor is gone. Their next chunks go through untouched.
+  weak_ptr_factory_.InvalidateWeakPtrs();
+  StopTimer();
+  FinishRecords(&download_, false);
+  FinishRecords(&upload_, false);
+  FinishRecords(&suspended_, false);
+  RunPendingCallbacks();
+}
+
+// static
+void DevToolsNetworkInterceptor::DeleteWhenIdle(
+    std::unique_ptr<DevToolsNetworkInterceptor> interceptor) {
+  // The observer may be owned by the caller.
+  interceptor->throttle_observer_.Reset();
+  interceptor->UpdateConditions(
+      base::MakeUnique<DevToolsNetworkConditions>(false));
+  DeleteOnceDrained(std::move(interceptor));
+}
+
+// static
+void DevToolsNetworkInterceptor::DeleteOnceDrained(
+    std::unique_ptr<DevToolsNetworkInterceptor> interceptor) {
+  // The batches of RunCompletions() go on meanwhile.
+  if (interceptor->completed_.empty())
+    return;
+  scoped_refptr<base::SingleThreadTaskRunner> task_runner =
+      interceptor->task_runner_;
+  task_runner->PostTask(
+      FROM_HERE,
+      base::Bind(&DevToolsNetworkInterceptor::DeleteOnceDrained,
+                 base::Passed(&interceptor)));
 }
 
 base::WeakPtr<DevToolsNetworkInterceptor>
@@ -59,60 +162,438 @@ void DevToolsNetworkInterceptor::FinishRecords(
   temp.swap(*records);
   for (const ThrottleRecord& record : temp) {
     bool failed = offline && !record.is_upload;
-    record.callback.Run(
-        failed ? net::ERR_INTERNET_DISCONNECTED : record.result,
-        record.bytes);
+    CompleteRecord(record, failed ? net::ERR_INTERNET_DISCONNECTED
+                                  : record.result);
+  }
+  ScheduleCompletions();
+}
+
+void DevToolsNetworkInterceptor::CompleteRecord(ThrottleRecord record,
+                                                int result) {
+  if (slots_[record.slot].cancelled) {
+    DropCancelledRecord(record);
+    return;
+  }
+  // The statistics go to the conditions the record was throttled with.
+  if (stats_)
+    AddStatsEntry(record, result, false, Now());
+  record.result = result;
+  record.completed = true;
+  completed_.push_back(record);
+}
+
+void DevToolsNetworkInterceptor::ScheduleCompletions() {
+  if (completed_.empty() || completions_scheduled_)
+    return;
+  completions_scheduled_ = true;
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&DevToolsNetworkInterceptor::RunCompletions,
+                 weak_ptr_factory_.GetWeakPtr()));
+}
+
+void DevToolsNetworkInterceptor::RunCompletions() {
+  completions_scheduled_ = false;
+  // Callbacks may queue or stop other completions.
+  for (size_t i = 0; i < kMaxCallbacksPerTask && !completed_.empty(); ++i) {
+    ThrottleRecord record = completed_.front();
+    completed_.pop_front();
+    RunCallback(record);
+  }
+  ScheduleCompletions();
+}
+
+void DevToolsNetworkInterceptor::RunCallback(const ThrottleRecord& record) {
+  if (slots_[record.slot].cancelled) {
+    DropCancelledRecord(record);
+    return;
   }
+  DCHECK(IsPending(record));
+  ReleaseSlot(record.slot);
+  record.callback.Run(record.result, record.bytes);
+}
+
+void DevToolsNetworkInterceptor::AddStatsEntry(const ThrottleRecord& record,
+                                               int result,
+                                               bool cancelled,
+                                               base::TimeTicks finished) {
+
+  DevToolsNetworkStats::Entry entry;
+  entry.transaction_id = record.transaction_id;
+  entry.is_start = record.is_start;
+  entry.is_upload = record.is_upload;
+  entry.bytes = record.result;
+  entry.result = result;
+  entry.queued = record.queued;
+  entry.released = record.released;
+  entry.finished = finished;
+  stats_->AddEntry(entry, cancelled);
+}
+
+DevToolsNetworkInterceptor::ThrottleHandle
+DevToolsNetworkInterceptor::AllocateSlot(uint32_t* slot) {
+  if (free_slots_.empty()) {
+    *slot = slots_.size();
+    slots_.push_back(Slot());
+  } else {
+    *slot = free_slots_.back();
+    free_slots_.pop_back();
+  }
+  slots_[*slot].pending = true;
+  return (static_cast<ThrottleHandle>(*slot) << 32) |
+      slots_[*slot].generation;
+}
+
+void DevToolsNetworkInterceptor::ReleaseSlot(uint32_t slot) {
+  Slot& entry = slots_[slot];
+  entry.pending = false;
+  entry.cancelled = false;
+  // Generation 0 would make a handle of slot 0 look invalid.
+  if (++entry.generation == 0)
+    entry.generation = 1;
+  free_slots_.push_back(slot);
+}
+
+bool DevToolsNetworkInterceptor::IsPending(
+    const ThrottleRecord& record) const {
+  return slots_[record.slot].pending;
+}
+
+void DevToolsNetworkInterceptor::PurgeCancelled() {
+  if (!cancelled_count_)
+    return;
+  PurgeCancelledRecords(&download_);
+  PurgeCancelledRecords(&upload_);
+  PurgeCancelledRecords(&suspended_);
+  PurgeCancelledRecords(&completed_);
+  DCHECK_EQ(0u, cancelled_count_);
+}
+
+template <typename Records>
+void DevToolsNetworkInterceptor::PurgeCancelledRecords(Records* records) {
+  auto removed =
+      std::stable_partition(records->begin(), records->end(),
+                            [this](const ThrottleRecord& record) {
+                              return IsPending(record);
+                            });
+  for (auto it = removed; it != records->end(); ++it)
+    DropCancelledRecord(*it);
+  records->erase(removed, records->end());
+}
+
+void DevToolsNetworkInterceptor::DropCancelledRecord(
+    const ThrottleRecord& record) {
+  const Slot& slot = slots_[record.slot];
+  DCHECK(slot.cancelled);
+  if (stats_ && !record.completed)
+    AddStatsEntry(record, net::ERR_ABORTED, true, slot.cancel_time);
+  ReleaseSlot(record.slot);
+  --cancelled_count_;
 }
 
 void DevToolsNetworkInterceptor::UpdateConditions(
     std::unique_ptr<DevToolsNetworkConditions> conditions) {
   DCHECK(conditions);
-  base::TimeTicks now = base::TimeTicks::Now();
+  base::TimeTicks now = Now();
   if (conditions_->IsThrottling())
     UpdateThrottled(now);
+  PurgeCancelled();
 
   conditions_ = std::move(conditions);
 
   bool offline = conditions_->offline();
   if (offline || !conditions_->IsThrottling()) {
-    timer_.Stop();
+    StopTimer();
     FinishRecords(&download_, offline);
     FinishRecords(&upload_, offline);
     FinishRecords(&suspended_, offline);
+    stats_ = conditions_->stats();
     return;
   }
+  stats_ = conditions_->stats();
 
   // Throttling.
   DCHECK(conditions_->download_throughput() != 0 ||
-         conditions_->upload_throughput() != 0);
+         conditions_->upload_throughput() != 0 ||
+         conditions_->download_trace() || conditions_->upload_trace());
   offset_ = now;
-
   download_last_tick_ = 0;
-  download_tick_length_ = CalculateTickLength(
-      conditions_->download_throughput());
-
   upload_last_tick_ = 0;
-  upload_tick_length_ = CalculateTickLength(conditions_->upload_throughput());
+
+  sockets_.clear();
+  stream_arrivals_.clear();
+  uplink_paid_order_.clear();
+  uplink_paid_transactions_.clear();
+  random_state_ = conditions_->seed();
+  throughput_scale_ = 1.0;
+  variance_period_ = base::TimeDelta();
+  bool has_trace =
+      conditions_->download_trace() || conditions_->upload_trace();
+  if (!has_trace && conditions_->throughput_variance() > 0 &&
+      conditions_->throughput_variance_period() > 0) {
+    variance_period_ = base::TimeDelta::FromMillisecondsD(
+        conditions_->throughput_variance_period());
+  }
+  next_variance_time_ = now;
+  UpdateTickLengths();
+  UpdateThroughputVariance(now);
 
   latency_length_ = base::TimeDelta();
+  upload_latency_length_ = base::TimeDelta();
   double latency = conditions_->latency();
   if (latency > 0)
     latency_length_ = base::TimeDelta::FromMillisecondsD(latency);
+  double upload_latency = std::min(conditions_->upload_latency(), latency);
+  if (upload_latency > 0)
+    upload_latency_length_ = base::TimeDelta::FromMillisecondsD(upload_latency);
   ArmTimer(now);
 }
 
+void DevToolsNetworkInterceptor::UpdateTickLengths() {
+  download_tick_length_ = CalculateTickLength(
+      conditions_->download_throughput() * throughput_scale_);
+  upload_tick_length_ = CalculateTickLength(
+      conditions_->upload_throughput() * throughput_scale_);
+}
+
+void DevToolsNetworkInterceptor::UpdateThroughputVariance(
+    base::TimeTicks now) {
+  if (variance_period_.is_zero() || now < next_variance_time_)
+    return;
+
+  // Bytes up to |now| have already been accounted at the previous rate, so
+  // restart the tick counting from here.
+  double variance = std::min(conditions_->throughput_variance(), 1.0);
+  throughput_scale_ =
+      std::max(1.0 + variance * (2 * NextRandom() - 1), 0.05);
+  offset_ = now;
+  download_last_tick_ = 0;
+  upload_last_tick_ = 0;
+  UpdateTickLengths();
+  next_variance_time_ = now + variance_period_;
+}
+
+double DevToolsNetworkInterceptor::NextRandom() {
+  // SplitMix64, which is tiny and gives the same sequence on every platform.
+  uint64_t z = (random_state_ += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return ToUnitInterval(z ^ (z >> 31));
+}
+
+int64_t DevToolsNetworkInterceptor::SampleJitter(base::TimeDelta latency) {
+  double jitter = conditions_->latency_jitter();
+  if (jitter <= 0)
+    return 0;
+
+  double sample = 0;
+  switch (conditions_->jitter_distribution()) {
+    case DevToolsNetworkConditions::JITTER_UNIFORM:
+      sample = jitter * (2 * NextRandom() - 1);
+      break;
+    case DevToolsNetworkConditions::JITTER_NORMAL: {
+      // Box-Muller transform, |jitter| is the standard deviation.
+      double u1 = 1.0 - NextRandom();
+      double u2 = NextRandom();
+      sample = jitter * std::sqrt(-2 * std::log(u1)) * std::cos(2 * kPi * u2);
+      break;
+    }
+    case DevToolsNetworkConditions::JITTER_PARETO:
+      // Only ever adds delay, with a mean of |jitter|.
+      sample = jitter * (kParetoShape - 1) *
+          (std::pow(1.0 - NextRandom(), -1 / kParetoShape) - 1);
+      break;
+  }
+
+  // The latency can shrink but never go below zero.
+  int64_t us_jitter = static_cast<int64_t>(sample * 1000);
+  return std::max(us_jitter, -latency.InMicroseconds());
+}
+
+int64_t DevToolsNetworkInterceptor::SampleLostPackets(int64_t bytes) {
+  double loss = conditions_->packet_loss();
+  if (loss <= 0 || bytes <= 0)
+    return 0;
+
+  int64_t packets = (bytes + kPacketSize - 1) / kPacketSize;
+  int64_t lost = 0;
+  for (int64_t i = 0; i < packets; ++i) {
+    if (NextRandom() < loss)
+      ++lost;
+  }
+  return lost;
+}
+
+void DevToolsNetworkInterceptor::AddUplinkPaid(uint64_t transaction_id) {
+  // A body sent again, e.g. after an authentication challenge, is the newest.
+  auto it = uplink_paid_transactions_.find(transaction_id);
+  if (it != uplink_paid_transactions_.end()) {
+    uplink_paid_order_.splice(uplink_paid_order_.end(), uplink_paid_order_,
+                              it->second);
+    return;
+  }
+
+  if (uplink_paid_transactions_.size() >= kMaxUplinkPaidTransactions) {
+    uplink_paid_transactions_.erase(uplink_paid_order_.front());
+    uplink_paid_order_.pop_front();
+  }
+  uplink_paid_transactions_[transaction_id] =
+      uplink_paid_order_.insert(uplink_paid_order_.end(), transaction_id);
+}
+
+bool DevToolsNetworkInterceptor::TakeUplinkPaid(uint64_t transaction_id) {
+  auto it = uplink_paid_transactions_.find(transaction_id);
+  if (it == uplink_paid_transactions_.end())
+    return false;
+  uplink_paid_order_.erase(it->second);
+  uplink_paid_transactions_.erase(it);
+  return true;
+}
+
+int64_t DevToolsNetworkInterceptor::GetConnectionDelay(
+    const Connection& connection,
+    int64_t bytes,
+    bool start,
+    bool is_upload,
+    base::TimeTicks now) {
+  int64_t initial_window = conditions_->initial_congestion_window();
+  if (initial_window <= 0 || latency_length_.is_zero())
+    return 0;
+
+  // The latency stands for one round trip.
+  int64_t round_trip = latency_length_.InMicroseconds();
+  int64_t round_trips = 0;
+  if (start && connection.is_new) {
+    // TCP, then DNS when the host was resolved and a full TLS 1.2 handshake.
+    round_trips += 1;
+    if (connection.resolved_host)
+      round_trips += 1;
+    if (connection.secure)
+      round_trips += 2;
+  }
+
+  if (!connection.socket_id || is_upload || bytes <= 0)
+    return round_trips * round_trip;
+
+  if (sockets_.size() >= kMaxSockets && !sockets_.count(connection.socket_id))
+    EvictIdlestSocket();
+  SocketState& socket = sockets_[connection.socket_id];
+  if (connection.is_new || !socket.congestion_window ||
+      (now - socket.last_active).InMicroseconds() >
+          kSlowStartRestartMicroseconds) {
+    socket.congestion_window = initial_window;
+  }
+  socket.last_active = now;
+
+  // Once the window covers the bandwidth-delay product the throughput is the
+  // limit, which the throttling already accounts.
+  int64_t max_window = std::numeric_limits<int64_t>::max() / 2;
+  double throughput = conditions_->download_throughput() * throughput_scale_;
+  if (throughput > 0) {
+    max_window = std::max(initial_window, static_cast<int64_t>(
+        throughput * latency_length_.InSecondsF() / kPacketSize));
+  }
+
+  // The first window goes out within the latency already charged.
+  int64_t packets = (bytes + kPacketSize - 1) / kPacketSize;
+  while (packets > socket.congestion_window &&
+         socket.congestion_window < max_window) {
+    packets -= socket.congestion_window;
+    socket.congestion_window =
+        std::min(socket.congestion_window * 2, max_window);
+    ++round_trips;
+  }
+  return round_trips * round_trip;
+}
+
+void DevToolsNetworkInterceptor::EvictIdlestSocket() {
+  auto idlest = std::min_element(
+      sockets_.begin(), sockets_.end(),
+      [](const std::pair<const uint32_t, SocketState>& a,
+         const std::pair<const uint32_t, SocketState>& b) {
+        return a.second.last_active < b.second.last_active;
+      });
+  if (idlest != sockets_.end())
+    sockets_.erase(idlest);
+}
+
+base::TimeTicks DevToolsNetworkInterceptor::GetStreamArrival(
+    uint64_t transaction_id, base::TimeTicks now, bool buffered) {
+  auto it = stream_arrivals_.find(transaction_id);
+  if (it != stream_arrivals_.end()) {
+    if (!buffered)
+      it->second = now;
+    return it->second;
+  }
+
+  if (stream_arrivals_.size() >= kMaxStreams) {
+    stream_arrivals_.erase(std::min_element(
+        stream_arrivals_.begin(), stream_arrivals_.end(),
+        [](const std::pair<const uint64_t, base::TimeTicks>& a,
+           const std::pair<const uint64_t, base::TimeTicks>& b) {
+          return a.second < b.second;
+        }));
+  }
+  stream_arrivals_[transaction_id] = now;
+  return now;
+}
+
+bool DevToolsNetworkInterceptor::IsDirectionThrottled(
+    bool is_upload, base::TimeTicks now) const {
+  DevToolsNetworkTrace* trace = is_upload ? conditions_->upload_trace()
+                                          : conditions_->download_trace();
+  if (trace && (conditions_->trace_loop() || now - offset_ < trace->duration()))
+    return true;
+  return is_upload ? conditions_->upload_throughput() != 0
+                   : conditions_->download_throughput() != 0;
+}
+
+int64_t DevToolsNetworkInterceptor::GetTickCount(base::TimeTicks now,
+                                                 bool is_upload) const {
+  base::TimeDelta elapsed = now - offset_;
+  base::TimeDelta tick_length =
+      is_upload ? upload_tick_length_ : download_tick_length_;
+  DevToolsNetworkTrace* trace = is_upload ? conditions_->upload_trace()
+                                          : conditions_->download_trace();
+  if (!trace)
+    return elapsed / tick_length;
+
+  bool loop = conditions_->trace_loop();
+  if (loop || elapsed < trace->duration())
+    return trace->GetDeliveryCount(elapsed, loop);
+
+  // The one-shot trace has been replayed, go on with the constant throughput.
+  int64_t count = trace->size();
+  if (!tick_length.is_zero())
+    count += (elapsed - trace->duration()) / tick_length;
+  return count;
+}
+
+base::TimeTicks DevToolsNetworkInterceptor::GetTickTime(int64_t tick,
+                                                        bool is_upload) const {
+  base::TimeDelta tick_length =
+      is_upload ? upload_tick_length_ : download_tick_length_;
+  DevToolsNetworkTrace* trace = is_upload ? conditions_->upload_trace()
+                                          : conditions_->download_trace();
+  if (!trace)
+    return offset_ + tick_length * tick;
+
+  bool loop = conditions_->trace_loop();
+  if (loop || tick <= trace->size())
+    return offset_ + trace->GetDeliveryTime(tick, loop);
+  return offset_ + trace->duration() + tick_length * (tick - trace->size());
+}
+
 uint64_t DevToolsNetworkInterceptor::UpdateThrottledRecords(
     base::TimeTicks now,
     ThrottleRecords* records,
     uint64_t last_tick,
-    base::TimeDelta tick_length) {
-  if (tick_length.is_zero()) {
-    DCHECK(records->empty());
+    bool is_upload) {
+  // Records left in an unthrottled direction get finished by ArmTimer().
+  if (!IsDirectionThrottled(is_upload, now))
     return last_tick;
-  }
 
-  int64_t new_tick = (now - offset_) / tick_length;
+  int64_t new_tick = GetTickCount(now, is_upload);
   int64_t ticks = new_tick - last_tick;
 
   int64_t length = records->size();
@@ -129,19 +610,24 @@ uint64_t DevToolsNetworkInterceptor::UpdateThrottledRecords(
 }
 
 void DevToolsNetworkInterceptor::UpdateThrottled(base::TimeTicks now) {
+  // Stopped throttles must not take a share of the bandwidth.
+  PurgeCancelled();
   download_last_tick_ = UpdateThrottledRecords(
-      now, &download_, download_last_tick_, download_tick_length_);
+      now, &download_, download_last_tick_, false);
   upload_last_tick_ = UpdateThrottledRecords(
-      now, &upload_, upload_last_tick_, upload_tick_length_);
+      now, &upload_, upload_last_tick_, true);
   UpdateSuspended(now);
 }
 
 void DevToolsNetworkInterceptor::UpdateSuspended(base::TimeTicks now) {
-  int64_t activation_baseline =
-      (now - latency_length_ - base::TimeTicks()).InMicroseconds();
+  int64_t now_us = (now - base::TimeTicks()).InMicroseconds();
   ThrottleRecords suspended;
-  for (const ThrottleRecord& record : suspended_) {
-    if (record.send_end <= activation_baseline) {
+  for (ThrottleRecord record : suspended_) {
+    int64_t activation = GetActivationTime(record);
+    if (activation <= now_us) {
+      // The latency may have elapsed before the chunk was queued.
+      record.released = std::max(record.queued, base::TimeTicks() +
+          base::TimeDelta::FromMicroseconds(activation));
       if (record.is_upload)
         upload_.push_back(record);
       else
@@ -153,6 +639,28 @@ void DevToolsNetworkInterceptor::UpdateSuspended(base::TimeTicks now) {
   suspended_.swap(suspended);
 }
 
+int64_t DevToolsNetworkInterceptor::GetActivationTime(
+    const ThrottleRecord& record) const {
+  int64_t activation = record.send_end + record.delay;
+  if (record.has_latency)
+    activation +=
+        GetLatency(record.is_upload, record.uplink_paid).InMicroseconds();
+  return activation;
+}
+
+base::TimeDelta DevToolsNetworkInterceptor::GetLatency(
+    bool is_upload, bool uplink_paid) const {
+  if (is_upload)
+    return upload_latency_length_;
+  // The latency is a full round trip measured from the end of the request.
+  return uplink_paid ? latency_length_ - upload_latency_length_
+                     : latency_length_;
+}
+
+base::TimeTicks DevToolsNetworkInterceptor::Now() const {
+  return clock_ ? clock_->NowTicks() : base::TimeTicks::Now();
+}
+
 void DevToolsNetworkInterceptor::CollectFinished(
     ThrottleRecords* records, ThrottleRecords* finished) {
   ThrottleRecords active;
@@ -166,66 +674,99 @@ void DevToolsNetworkInterceptor::CollectFinished(
 }
 
 void DevToolsNetworkInterceptor::OnTimer() {
-  base::TimeTicks now = base::TimeTicks::Now();
+  timer_time_ = base::TimeTicks();
+  base::TimeTicks now = Now();
   UpdateThrottled(now);
+  UpdateThroughputVariance(now);
 
   ThrottleRecords finished;
   CollectFinished(&download_, &finished);
   CollectFinished(&upload_, &finished);
   for (const ThrottleRecord& record : finished)
-    record.callback.Run(record.result, record.bytes);
+    CompleteRecord(record, record.result);
 
   ArmTimer(now);
+  // Already in a task, the first batch does not need another one.
+  if (!completions_scheduled_)
+    RunCompletions();
 }
 
 base::TimeTicks DevToolsNetworkInterceptor::CalculateDesiredTime(
     const ThrottleRecords& records,
     uint64_t last_tick,
-    base::TimeDelta tick_length) {
+    bool is_upload) {
   int64_t min_ticks_left = 0x10000L;
   size_t count = records.size();
   for (size_t i = 0; i < count; ++i) {
-    int64_t packets_left = (records[i].bytes + kPacketSize - 1) / kPacketSize;
+    // Records only finish once |bytes| drops below zero.
+    int64_t packets_left = records[i].bytes / kPacketSize + 1;
     int64_t ticks_left = (i + 1) + count * (packets_left - 1);
     if (i == 0 || ticks_left < min_ticks_left)
       min_ticks_left = ticks_left;
   }
-  return offset_ + tick_length * (last_tick + min_ticks_left);
+  return GetTickTime(last_tick + min_ticks_left, is_upload);
 }
 
 void DevToolsNetworkInterceptor::ArmTimer(base::TimeTicks now) {
   size_t suspend_count = suspended_.size();
   if (download_.empty() && upload_.empty() && !suspend_count) {
-    timer_.Stop();
+    StopTimer();
     return;
   }
 
-  base::TimeTicks desired_time = CalculateDesiredTime(
-      download_, download_last_tick_, download_tick_length_);
-  if (desired_time == offset_) {
+  if (!IsDirectionThrottled(false, now))
     FinishRecords(&download_, false);
-  }
+  if (!IsDirectionThrottled(true, now))
+    FinishRecords(&upload_, false);
 
-  base::TimeTicks upload_time = CalculateDesiredTime(
-      upload_, upload_last_tick_, upload_tick_length_);
-  if (upload_time != offset_ && upload_time < desired_time)
-    desired_time = upload_time;
+  base::TimeTicks desired_time = base::TimeTicks::Max();
+  if (!download_.empty()) {
+    desired_time = CalculateDesiredTime(
+        download_, download_last_tick_, false);
+  }
+  if (!upload_.empty()) {
+    desired_time = std::min(desired_time, CalculateDesiredTime(
+        upload_, upload_last_tick_, true));
+  }
 
-  int64_t min_baseline = std::numeric_limits<int64_t>::max();
+  suspend_count = suspended_.size();
+  int64_t min_activation = std::numeric_limits<int64_t>::max();
   for (size_t i = 0; i < suspend_count; ++i) {
-    if (suspended_[i].send_end < min_baseline)
-      min_baseline = suspended_[i].send_end;
+    int64_t activation = GetActivationTime(suspended_[i]);
+    if (activation < min_activation)
+      min_activation = activation;
   }
   if (suspend_count) {
     base::TimeTicks activation_time = base::TimeTicks() +
-        base::TimeDelta::FromMicroseconds(min_baseline) + latency_length_;
+        base::TimeDelta::FromMicroseconds(min_activation);
     if (activation_time < desired_time)
       desired_time = activation_time;
   }
 
-  timer_.Start(
-      FROM_HERE, (desired_time - now).magnitude(),
-      base::Bind(&DevToolsNetworkInterceptor::OnTimer, base::Unretained(this)));
+  if (desired_time.is_max()) {
+    StopTimer();
+    return;
+  }
+
+  if (!variance_period_.is_zero() && next_variance_time_ < desired_time)
+    desired_time = next_variance_time_;
+
+  // A task running earlier re-arms the timer when it fires.
+  if (!timer_time_.is_null() && timer_time_ <= desired_time)
+    return;
+
+  StopTimer();
+  timer_time_ = desired_time;
+  task_runner_->PostDelayedTask(
+      FROM_HERE,
+      base::Bind(&DevToolsNetworkInterceptor::OnTimer,
+                 timer_weak_factory_.GetWeakPtr()),
+      std::max(desired_time - now, base::TimeDelta()));
+}
+
+void DevToolsNetworkInterceptor::StopTimer() {
+  timer_weak_factory_.InvalidateWeakPtrs();
+  timer_time_ = base::TimeTicks();
 }
 
 int DevToolsNetworkInterceptor::StartThrottle(
@@ -234,31 +775,80 @@ int DevToolsNetworkInterceptor::StartThrottle(
     base::TimeTicks send_end,
     bool start,
     bool is_upload,
-    const ThrottleCallback& callback) {
+    uint64_t transaction_id,
+    const Connection& connection,
+    const ThrottleCallback& callback,
+    ThrottleHandle* handle) {
+  *handle = kInvalidThrottleHandle;
   if (result < 0)
     return result;
 
   if (conditions_->offline())
     return is_upload ? result : net::ERR_INTERNET_DISCONNECTED;
 
-  if ((is_upload && !conditions_->upload_throughput()) ||
-      (!is_upload && !conditions_->download_throughput())) {
+  bool is_start = start && !is_upload;
+  if (!throttle_observer_.is_null())
+    throttle_observer_.Run(result, is_start, is_upload);
+
+  base::TimeTicks now = Now();
+  if (!IsDirectionThrottled(is_upload, now))
     return result;
+
+  // The send time was taken from the real clock.
+  if (clock_ && !send_end.is_null())
+    send_end = now;
+  // The latency is a pipeline delay, only the first chunk of a burst waits
+  // for it.
+  if (connection.streaming && !is_upload && !send_end.is_null()) {
+    send_end =
+        GetStreamArrival(transaction_id, send_end, connection.buffered);
   }
 
   ThrottleRecord record;
   record.result = result;
   record.bytes = bytes;
   record.callback = callback;
+  record.send_end = 0;
+  record.delay = 0;
+  record.is_start = is_start;
+  // Request bodies only wait when the uplink has a latency of its own.
+  record.has_latency = is_upload ? start && !upload_latency_length_.is_zero()
+                                 : start || connection.streaming;
+  record.uplink_paid = false;
+  if (is_upload && record.has_latency) {
+    AddUplinkPaid(transaction_id);
+  } else if (is_start) {
+    record.uplink_paid = TakeUplinkPaid(transaction_id);
+  }
+  base::TimeDelta latency = GetLatency(is_upload, record.uplink_paid);
   record.is_upload = is_upload;
+  record.completed = false;
+  record.transaction_id = transaction_id;
+  record.queued = now;
+  *handle = AllocateSlot(&record.slot);
 
-  base::TimeTicks now = base::TimeTicks::Now();
   UpdateThrottled(now);
-  if (start && latency_length_ != base::TimeDelta()) {
-    record.send_end = (send_end - base::TimeTicks()).InMicroseconds();
+  UpdateThroughputVariance(now);
+
+  // Lost packets are sent again, which costs both bandwidth and a
+  // retransmission timeout.
+  int64_t lost_packets = SampleLostPackets(bytes);
+  if (lost_packets) {
+    record.bytes += lost_packets * kPacketSize;
+    record.delay += static_cast<int64_t>(
+        conditions_->retransmission_timeout() * 1000);
+  }
+  if (record.has_latency)
+    record.delay += SampleJitter(latency);
+  record.delay += GetConnectionDelay(connection, bytes, start, is_upload, now);
+
+  if ((record.has_latency && !latency.is_zero()) || record.delay > 0) {
+    base::TimeTicks suspend_start = record.has_latency ? send_end : now;
+    record.send_end = (suspend_start - base::TimeTicks()).InMicroseconds();
     suspended_.push_back(record);
     UpdateSuspended(now);
   } else {
+    record.released = now;
     if (is_upload)
       upload_.push_back(record);
     else
@@ -269,25 +859,45 @@ int DevToolsNetworkInterceptor::StartThrottle(
   return net::ERR_IO_PENDING;
 }
 
-void DevToolsNetworkInterceptor::StopThrottle(
-    const ThrottleCallback& callback) {
-  RemoveRecord(&download_, callback);
-  RemoveRecord(&upload_, callback);
-  RemoveRecord(&suspended_, callback);
+void DevToolsNetworkInterceptor::StopThrottle(ThrottleHandle handle) {
+  size_t index = static_cast<size_t>(handle >> 32);
+  uint32_t generation = static_cast<uint32_t>(handle);
+  if (index >= slots_.size())
+    return;
+  Slot& slot = slots_[index];
+  if (slot.generation != generation || !slot.pending)
+    return;
+
+  slot.pending = false;
+  slot.cancelled = true;
+  slot.cancel_time = Now();
+  ++cancelled_count_;
 }
 
-void DevToolsNetworkInterceptor::RemoveRecord(
-    ThrottleRecords* records, const ThrottleCallback& callback) {
-  records->erase(
-      std::remove_if(records->begin(), records->end(),
-                     [&callback](const ThrottleRecord& record){
-                       return record.callback.Equals(callback);
-                     }),
-      records->end());
+void DevToolsNetworkInterceptor::RunPendingCallbacks() {
+  while (!completed_.empty()) {
+    ThrottleRecord record = completed_.front();
+    completed_.pop_front();
+    RunCallback(record);
+  }
 }
 
 bool DevToolsNetworkInterceptor::IsOffline() {
   return conditions_->offline();
 }
 
+bool DevToolsNetworkInterceptor::ShouldThrottleUpload() {
+  return !conditions_->offline() && IsDirectionThrottled(true, Now());
+}
+
+void DevToolsNetworkInterceptor::SetThrottleObserver(
+    const ThrottleObserver& observer) {
+  throttle_observer_ = observer;
+}
+
+void DevToolsNetworkInterceptor::ReportUnthrottledWebSocket() {
+  if (stats_)
+    stats_->AddUnthrottledWebSocket();
+}
+
 }  // namespace brightray
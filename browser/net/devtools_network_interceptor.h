@@ -5,46 +5,117 @@
 #ifndef BROWSER_DEVTOOLS_NETWORK_INTERCEPTOR_H_
 #define BROWSER_DEVTOOLS_NETWORK_INTERCEPTOR_H_
 
+#include <deque>
+#include <list>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "base/callback.h"
 #include "base/macros.h"
-#include "base/timer/timer.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 
 namespace base {
-class TimeDelta;
-class TimeTicks;
+class SingleThreadTaskRunner;
+class TickClock;
 }
 
 namespace brightray {
 
 class DevToolsNetworkConditions;
+class DevToolsNetworkStats;
 class DevToolsNetworkTransaction;
 
 class DevToolsNetworkInterceptor {
  public:
   using ThrottleCallback = base::Callback<void(int, int64_t)>;
+  // Identifies a pending throttle. It is never reused, stopping a throttle
+  // whose callback already ran does nothing.
+  using ThrottleHandle = uint64_t;
+  static const ThrottleHandle kInvalidThrottleHandle = 0;
+  // Told about every chunk passed to StartThrottle() while online, |result|
+  // is the size of the payload read or sent by the chunk.
+  using ThrottleObserver =
+      base::Callback<void(int result, bool start, bool is_upload)>;
+
+  // The socket a chunk went through, used by the connection model.
+  struct Connection {
+    Connection();
+
+    // NetLog source id of the socket, 0 when unknown.
+    uint32_t socket_id;
+    // Only set on the first chunk of a transaction that opened the socket,
+    // the request body when there is one.
+    bool is_new;
+    bool resolved_host;
+    bool secure;
+    // Every chunk of a stream pays the latency from its arrival, not only
+    // the first one, as for WebSocket frames and server-sent events.
+    bool streaming;
+    // Set on a chunk of a stream which was already waiting when it was read.
+    // It arrived with the previous chunk and shares its latency, so a burst
+    // of frames takes one round trip instead of one per read.
+    bool buffered;
+  };
 
   DevToolsNetworkInterceptor();
+  // Runs on |clock| and |task_runner| instead of the real time of the current
+  // thread, |clock| must outlive the interceptor.
+  DevToolsNetworkInterceptor(
+      base::TickClock* clock,
+      scoped_refptr<base::SingleThreadTaskRunner> task_runner);
+  // Releases the throttled chunks, their callbacks run before it returns.
+  // Owners drop interceptors through DeleteWhenIdle() instead, so that the
+  // callbacks run in batches.
   virtual ~DevToolsNetworkInterceptor();
 
+  // Releases the throttled chunks of |interceptor| like unthrottled conditions
+  // would, then deletes it on its task runner once their callbacks ran. The
+  // chunks throttled meanwhile go through untouched.
+  static void DeleteWhenIdle(
+      std::unique_ptr<DevToolsNetworkInterceptor> interceptor);
+
   base::WeakPtr<DevToolsNetworkInterceptor> GetWeakPtr();
 
   // Applies network emulation configuration.
   void UpdateConditions(std::unique_ptr<DevToolsNetworkConditions> conditions);
 
   // Throttles with |is_upload == true| always succeed, even in offline mode.
+  // |send_end| is when the chunk was requested, it must be set for the first
+  // chunk of a transaction and for every chunk of a streaming connection.
+  // The first chunk of a request body passes |start| to wait for the uplink
+  // latency, only the first download chunk starts a transaction.
+  // |transaction_id| groups the chunks of a transaction in the statistics.
+  // When ERR_IO_PENDING is returned |handle| is set to stop the throttle
+  // before |callback| runs.
   int StartThrottle(int result,
                     int64_t bytes,
                     base::TimeTicks send_end,
                     bool start,
                     bool is_upload,
-                    const ThrottleCallback& callback);
-  void StopThrottle(const ThrottleCallback& callback);
+                    uint64_t transaction_id,
+                    const Connection& connection,
+                    const ThrottleCallback& callback,
+                    ThrottleHandle* handle);
+  // Runs in constant time, the record is dropped by the next update.
+  void StopThrottle(ThrottleHandle handle);
 
   bool IsOffline();
 
+  // Whether uploads are currently accounted, they can go through untouched
+  // otherwise.
+  bool ShouldThrottleUpload();
+
+  void SetThrottleObserver(const ThrottleObserver& observer);
+
+  // Counts a stream the interceptor cannot throttle in the statistics, so
+  // that the DevTools client knows about it.
+  void ReportUnthrottledWebSocket();
+
  private:
   struct ThrottleRecord {
    public:
@@ -55,32 +126,133 @@ class DevToolsNetworkInterceptor {
     int result;
     int64_t bytes;
     int64_t send_end;
+    // Extra time spent in |suspended_| on top of the latency, in microseconds.
+    int64_t delay;
+    bool is_start;
+    // Whether the latency applies to this record.
+    bool has_latency;
+    // Set on the first chunk of a response whose request body already waited
+    // for the uplink latency, only the rest of the round trip is left.
+    bool uplink_paid;
     bool is_upload;
+    // Set once the record waits in |completed_|, |result| then holds what is
+    // passed to the callback.
+    bool completed;
     ThrottleCallback callback;
+
+    // Index in |slots_|.
+    uint32_t slot;
+
+    // Only used by the statistics.
+    uint64_t transaction_id;
+    base::TimeTicks queued;
+    base::TimeTicks released;
   };
 
   using ThrottleRecords = std::vector<ThrottleRecord>;
 
+  // Tracks whether the record of a handle is still pending. The generation
+  // is bumped every time the slot is released, which invalidates the handle.
+  struct Slot {
+    Slot();
+
+    uint32_t generation;
+    bool pending;
+    bool cancelled;
+    base::TimeTicks cancel_time;
+  };
+
+  struct SocketState {
+    SocketState();
+
+    int64_t congestion_window;
+    base::TimeTicks last_active;
+  };
+
   void FinishRecords(ThrottleRecords* records, bool offline);
+  // Queues the callback of |record|, callbacks are run in batches so that
+  // releasing many records at once does not hold the thread.
+  void CompleteRecord(ThrottleRecord record, int result);
+  void ScheduleCompletions();
+  void RunCompletions();
+  // Runs the queued callbacks at once.
+  void RunPendingCallbacks();
+  static void DeleteOnceDrained(
+      std::unique_ptr<DevToolsNetworkInterceptor> interceptor);
+  void AddStatsEntry(const ThrottleRecord& record,
+                     int result,
+                     bool cancelled,
+                     base::TimeTicks finished);
+
+  ThrottleHandle AllocateSlot(uint32_t* slot);
+  void ReleaseSlot(uint32_t slot);
+  bool IsPending(const ThrottleRecord& record) const;
+  // Drops the records of the stopped throttles.
+  void PurgeCancelled();
+  template <typename Records>
+  void PurgeCancelledRecords(Records* records);
+  void DropCancelledRecord(const ThrottleRecord& record);
+  // Releases the slot of |record| and runs its callback, unless it has been
+  // stopped, maybe by a callback run just before.
+  void RunCallback(const ThrottleRecord& record);
+
+  // Whether bytes sent in the direction are accounted, either by a trace or
+  // by a constant throughput.
+  bool IsDirectionThrottled(bool is_upload, base::TimeTicks now) const;
+  int64_t GetTickCount(base::TimeTicks now, bool is_upload) const;
+  base::TimeTicks GetTickTime(int64_t tick, bool is_upload) const;
 
   uint64_t UpdateThrottledRecords(base::TimeTicks now,
                                   ThrottleRecords* records,
                                   uint64_t last_tick,
-                                  base::TimeDelta tick_length);
+                                  bool is_upload);
   void UpdateThrottled(base::TimeTicks now);
   void UpdateSuspended(base::TimeTicks now);
+  int64_t GetActivationTime(const ThrottleRecord& record) const;
+  base::TimeDelta GetLatency(bool is_upload, bool uplink_paid) const;
+
+  void UpdateTickLengths();
+  void UpdateThroughputVariance(base::TimeTicks now);
+
+  double NextRandom();
+  int64_t SampleJitter(base::TimeDelta latency);
+  int64_t SampleLostPackets(int64_t bytes);
+
+  void AddUplinkPaid(uint64_t transaction_id);
+  // Returns whether the request body of |transaction_id| paid the uplink
+  // latency, and forgets it.
+  bool TakeUplinkPaid(uint64_t transaction_id);
+
+  // Extra time in microseconds spent in handshakes and slow start.
+  int64_t GetConnectionDelay(const Connection& connection,
+                             int64_t bytes,
+                             bool start,
+                             bool is_upload,
+                             base::TimeTicks now);
+  // Forgets the socket which has been idle for the longest time, the others
+  // keep their congestion window.
+  void EvictIdlestSocket();
+  // Returns when a chunk of the stream of |transaction_id| arrived, |now| or
+  // with the previous chunk when |buffered|.
+  base::TimeTicks GetStreamArrival(uint64_t transaction_id,
+                                   base::TimeTicks now,
+                                   bool buffered);
+
+  base::TimeTicks Now() const;
 
   void CollectFinished(ThrottleRecords* records, ThrottleRecords* finished);
   void OnTimer();
 
   base::TimeTicks CalculateDesiredTime(const ThrottleRecords& records,
                                        uint64_t last_tick,
-                                       base::TimeDelta tick_length);
+                                       bool is_upload);
   void ArmTimer(base::TimeTicks now);
-
-  void RemoveRecord(ThrottleRecords* records, const ThrottleCallback& callback);
+  void StopTimer();
 
   std::unique_ptr<DevToolsNetworkConditions> conditions_;
+  ThrottleObserver throttle_observer_;
+  // Those of the conditions the current records were throttled with.
+  scoped_refptr<DevToolsNetworkStats> stats_;
 
   // Throttables suspended for a "latency" period.
   ThrottleRecords suspended_;
@@ -89,14 +261,48 @@ class DevToolsNetworkInterceptor {
   ThrottleRecords download_;
   ThrottleRecords upload_;
 
-  base::OneShotTimer timer_;
+  // Finished throttles whose callbacks have not run yet.
+  std::deque<ThrottleRecord> completed_;
+  bool completions_scheduled_;
+
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> free_slots_;
+  // Stopped throttles whose records are still queued.
+  size_t cancelled_count_;
+
+  base::TickClock* clock_;
+  scoped_refptr<base::SingleThreadTaskRunner> task_runner_;
+  // Run time of the pending OnTimer() task, null when there is none.
+  base::TimeTicks timer_time_;
+
   base::TimeTicks offset_;
   base::TimeDelta download_tick_length_;
   base::TimeDelta upload_tick_length_;
   base::TimeDelta latency_length_;
+  base::TimeDelta upload_latency_length_;
   uint64_t download_last_tick_;
   uint64_t upload_last_tick_;
 
+  // State of the connection model.
+  std::unordered_map<uint32_t, SocketState> sockets_;
+
+  // Arrival of the last chunk of each stream by transaction.
+  std::unordered_map<uint64_t, base::TimeTicks> stream_arrivals_;
+
+  // Transactions whose request body waited for the uplink latency, until
+  // their response starts. The oldest ones are forgotten first.
+  std::list<uint64_t> uplink_paid_order_;
+  std::unordered_map<uint64_t, std::list<uint64_t>::iterator>
+      uplink_paid_transactions_;
+
+  // State of the variance model.
+  uint64_t random_state_;
+  double throughput_scale_;
+  base::TimeDelta variance_period_;
+  base::TimeTicks next_variance_time_;
+
+  // Invalidated to cancel the pending OnTimer() task.
+  base::WeakPtrFactory<DevToolsNetworkInterceptor> timer_weak_factory_;
   base::WeakPtrFactory<DevToolsNetworkInterceptor> weak_ptr_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkInterceptor);
@@ -0,0 +1,280 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_interceptor.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "browser/net/devtools_network_conditions.h"
+#include "browser/net/devtools_network_virtual_time.h"
+#include "net/base/net_errors.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brightray {
+
+namespace {
+
+using Connection = DevToolsNetworkInterceptor::Connection;
+using ThrottleHandle = DevToolsNetworkInterceptor::ThrottleHandle;
+
+}  // namespace
+
+// Runs the interceptor in virtual time, so that the tests do not wait for the
+// emulated network and the delays are exact.
+class DevToolsNetworkInterceptorTest : public testing::Test {
+ protected:
+  DevToolsNetworkInterceptorTest()
+      : virtual_time_(new DevToolsNetworkVirtualTime(
+            base::ThreadTaskRunnerHandle::Get())),
+        interceptor_(new DevToolsNetworkInterceptor(virtual_time_->clock(),
+                                                    virtual_time_)) {
+    start_ = Now();
+  }
+
+  base::TimeTicks Now() { return virtual_time_->clock()->NowTicks(); }
+
+  void UpdateConditions(
+      std::unique_ptr<DevToolsNetworkConditions> conditions) {
+    interceptor_->UpdateConditions(std::move(conditions));
+  }
+
+  // Throttles a download chunk of |bytes|, when its callback runs the time
+  // since |start_| is added to |finished_|.
+  ThrottleHandle Throttle(int64_t bytes,
+                          bool start,
+                          uint64_t transaction_id,
+                          const Connection& connection) {
+    base::TimeTicks send_end;
+    if (start || connection.streaming)
+      send_end = Now();
+    ThrottleHandle handle = DevToolsNetworkInterceptor::kInvalidThrottleHandle;
+    int rv = interceptor_->StartThrottle(
+        static_cast<int>(bytes), bytes, send_end, start, false,
+        transaction_id, connection,
+        base::Bind(&DevToolsNetworkInterceptorTest::OnThrottled,
+                   base::Unretained(this)),
+        &handle);
+    EXPECT_EQ(net::ERR_IO_PENDING, rv);
+    return handle;
+  }
+
+  void RunUntilIdle() { base::RunLoop().RunUntilIdle(); }
+
+  void OnThrottled(int result, int64_t bytes) {
+    results_.push_back(result);
+    finished_.push_back(Now() - start_);
+  }
+
+  // Adds the count of callbacks run so far to |callback_counts_| once the
+  // tasks already posted to the interceptor have run.
+  void PostCountCallbacks() {
+    virtual_time_->PostTask(
+        FROM_HERE, base::Bind(&DevToolsNetworkInterceptorTest::CountCallbacks,
+                              base::Unretained(this)));
+  }
+
+  void CountCallbacks() { callback_counts_.push_back(results_.size()); }
+
+  base::MessageLoop message_loop_;
+  scoped_refptr<DevToolsNetworkVirtualTime> virtual_time_;
+  std::unique_ptr<DevToolsNetworkInterceptor> interceptor_;
+  base::TimeTicks start_;
+
+  std::vector<int> results_;
+  std::vector<base::TimeDelta> finished_;
+  std::vector<size_t> callback_counts_;
+};
+
+TEST_F(DevToolsNetworkInterceptorTest, SeedMakesJitterDeterministic) {
+  const uint64_t seeds[] = {42, 42, 7};
+  std::vector<base::TimeDelta> runs[3];
+  for (size_t i = 0; i < 3; ++i) {
+    std::unique_ptr<DevToolsNetworkConditions> conditions(
+        new DevToolsNetworkConditions(false, 100, 100000, 0));
+    conditions->set_latency_jitter(50,
+                                   DevToolsNetworkConditions::JITTER_NORMAL);
+    conditions->set_packet_loss(0.05, 200);
+    conditions->set_seed(seeds[i]);
+    UpdateConditions(std::move(conditions));
+
+    finished_.clear();
+    start_ = Now();
+    for (int j = 0; j < 5; ++j)
+      Throttle(30000, true, j + 1, Connection());
+    RunUntilIdle();
+    runs[i] = finished_;
+  }
+
+  ASSERT_EQ(5u, runs[0].size());
+  // The same seed replays the same network, another one does not.
+  EXPECT_EQ(runs[0], runs[1]);
+  EXPECT_NE(runs[0], runs[2]);
+}
+
+TEST_F(DevToolsNetworkInterceptorTest, NewConnectionPaysHandshakes) {
+  std::unique_ptr<DevToolsNetworkConditions> conditions(
+      new DevToolsNetworkConditions(false, 100, 10000000, 0));
+  conditions->set_initial_congestion_window(10);
+  UpdateConditions(std::move(conditions));
+
+  Connection connection;
+  connection.socket_id = 1;
+  connection.is_new = true;
+  connection.resolved_host = true;
+  connection.secure = true;
+  Throttle(1000, true, 1, connection);
+  RunUntilIdle();
+
+  connection.is_new = false;
+  start_ = Now();
+  Throttle(1000, true, 2, connection);
+  RunUntilIdle();
+
+  // TCP, DNS and two TLS round trips on top of the latency.
+  ASSERT_EQ(2u, finished_.size());
+  EXPECT_EQ(500, finished_[0].InMilliseconds());
+  EXPECT_EQ(100, finished_[1].InMilliseconds());
+}
+
+TEST_F(DevToolsNetworkInterceptorTest, EvictsIdlestSocket) {
+  std::unique_ptr<DevToolsNetworkConditions> conditions(
+      new DevToolsNetworkConditions(false, 100, 10000000, 0));
+  conditions->set_initial_congestion_window(10);
+  UpdateConditions(std::move(conditions));
+
+  // Grows the congestion windows of the first two sockets, the first one
+  // being used last.
+  Connection first;
+  first.socket_id = 1;
+  Connection second;
+  second.socket_id = 2;
+  Throttle(100000, false, 1, first);
+  Throttle(100000, false, 2, second);
+  RunUntilIdle();
+  Throttle(100000, false, 1, first);
+  RunUntilIdle();
+
+  // Fills the model, which forgets the second socket.
+  for (uint32_t socket_id = 3; socket_id <= 257; ++socket_id) {
+    Connection connection;
+    connection.socket_id = socket_id;
+    Throttle(1000, false, socket_id, connection);
+  }
+  RunUntilIdle();
+
+  finished_.clear();
+  start_ = Now();
+  Throttle(100000, false, 1, first);
+  RunUntilIdle();
+  start_ = Now();
+  Throttle(100000, false, 2, second);
+  RunUntilIdle();
+
+  // Only the forgotten socket goes through slow start again, 69 packets
+  // take two more round trips from a window of 10.
+  ASSERT_EQ(2u, finished_.size());
+  EXPECT_EQ(10, finished_[0].InMilliseconds());
+  EXPECT_EQ(210, finished_[1].InMilliseconds());
+}
+
+TEST_F(DevToolsNetworkInterceptorTest, BufferedChunksShareLatency) {
+  UpdateConditions(std::unique_ptr<DevToolsNetworkConditions>(
+      new DevToolsNetworkConditions(false, 100, 10000000, 0)));
+
+  Connection connection;
+  connection.streaming = true;
+  Throttle(10, true, 1, connection);
+  RunUntilIdle();
+  // Read right after the first one, it arrived with it.
+  connection.buffered = true;
+  Throttle(10, false, 1, connection);
+  RunUntilIdle();
+  // Arrives on its own after the others were delivered.
+  connection.buffered = false;
+  Throttle(10, false, 1, connection);
+  RunUntilIdle();
+
+  ASSERT_EQ(3u, finished_.size());
+  EXPECT_EQ(100, finished_[0].InMilliseconds());
+  EXPECT_EQ(100, finished_[1].InMilliseconds());
+  EXPECT_EQ(200, finished_[2].InMilliseconds());
+}
+
+TEST_F(DevToolsNetworkInterceptorTest, StopThrottle) {
+  UpdateConditions(std::unique_ptr<DevToolsNetworkConditions>(
+      new DevToolsNetworkConditions(false, 100, 10000000, 0)));
+
+  ThrottleHandle stopped = Throttle(10, true, 1, Connection());
+  ThrottleHandle finished = Throttle(20, true, 2, Connection());
+  EXPECT_NE(stopped, finished);
+  interceptor_->StopThrottle(stopped);
+  // Stopping twice, or an invalid handle, does nothing.
+  interceptor_->StopThrottle(stopped);
+  interceptor_->StopThrottle(
+      DevToolsNetworkInterceptor::kInvalidThrottleHandle);
+  RunUntilIdle();
+
+  ASSERT_EQ(1u, results_.size());
+  EXPECT_EQ(20, results_[0]);
+
+  // The slots are reused, but not the handles of the finished throttles.
+  ThrottleHandle next = Throttle(30, true, 3, Connection());
+  EXPECT_NE(stopped, next);
+  EXPECT_NE(finished, next);
+  interceptor_->StopThrottle(stopped);
+  interceptor_->StopThrottle(finished);
+  RunUntilIdle();
+
+  ASSERT_EQ(2u, results_.size());
+  EXPECT_EQ(30, results_[1]);
+}
+
+TEST_F(DevToolsNetworkInterceptorTest, CallbacksRunInBatches) {
+  UpdateConditions(std::unique_ptr<DevToolsNetworkConditions>(
+      new DevToolsNetworkConditions(false, 0, 1000, 0)));
+  for (int i = 0; i < 40; ++i)
+    Throttle(100000, false, i + 1, Connection());
+
+  // Going offline releases every chunk, the callbacks run later.
+  UpdateConditions(std::unique_ptr<DevToolsNetworkConditions>(
+      new DevToolsNetworkConditions(true)));
+  EXPECT_TRUE(results_.empty());
+  // Counts between the first batch and the next one.
+  PostCountCallbacks();
+  RunUntilIdle();
+
+  ASSERT_EQ(1u, callback_counts_.size());
+  EXPECT_EQ(32u, callback_counts_[0]);
+  ASSERT_EQ(40u, results_.size());
+  for (int result : results_)
+    EXPECT_EQ(net::ERR_INTERNET_DISCONNECTED, result);
+}
+
+TEST_F(DevToolsNetworkInterceptorTest, DeleteWhenIdle) {
+  UpdateConditions(std::unique_ptr<DevToolsNetworkConditions>(
+      new DevToolsNetworkConditions(false, 0, 1000, 0)));
+  for (int i = 0; i < 40; ++i)
+    Throttle(100000, false, i + 1, Connection());
+
+  base::WeakPtr<DevToolsNetworkInterceptor> interceptor =
+      interceptor_->GetWeakPtr();
+  DevToolsNetworkInterceptor::DeleteWhenIdle(std::move(interceptor_));
+  EXPECT_TRUE(results_.empty());
+  EXPECT_TRUE(interceptor);
+  RunUntilIdle();
+
+  // Released as if the network was not throttled, then deleted.
+  EXPECT_FALSE(interceptor);
+  ASSERT_EQ(40u, results_.size());
+  for (int result : results_)
+    EXPECT_EQ(100000, result);
+}
+
+}  // namespace brightray
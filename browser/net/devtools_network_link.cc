@@ -0,0 +1,159 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_link.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "base/bind.h"
+#include "base/lazy_instance.h"
+#include "browser/net/devtools_network_conditions.h"
+#include "browser/net/devtools_network_controller.h"
+#include "browser/net/devtools_network_interceptor.h"
+
+using content::BrowserThread;
+
+namespace brightray {
+
+namespace {
+
+// Only used on the UI thread.
+struct LinkRegistry {
+  std::unordered_map<std::string, scoped_refptr<DevToolsNetworkLink>> links;
+  // Client id to link name.
+  std::unordered_map<std::string, std::string> clients;
+};
+
+base::LazyInstance<LinkRegistry>::Leaky g_registry = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+DevToolsNetworkLink::Stats::Stats()
+    : clients(0),
+      transactions(0),
+      download_bytes(0),
+      upload_bytes(0) {
+}
+
+// static
+scoped_refptr<DevToolsNetworkLink> DevToolsNetworkLink::Attach(
+    const std::string& name, const std::string& client_id) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  LinkRegistry& registry = g_registry.Get();
+  auto it = registry.clients.find(client_id);
+  if (it != registry.clients.end() && it->second == name)
+    return registry.links[name];
+
+  Detach(client_id);
+  scoped_refptr<DevToolsNetworkLink>& link = registry.links[name];
+  if (!link)
+    link = new DevToolsNetworkLink(name);
+  link->AddClients(1);
+  registry.clients[client_id] = name;
+  return link;
+}
+
+// static
+void DevToolsNetworkLink::Detach(const std::string& client_id) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  LinkRegistry& registry = g_registry.Get();
+  auto it = registry.clients.find(client_id);
+  if (it == registry.clients.end())
+    return;
+
+  auto link = registry.links.find(it->second);
+  registry.clients.erase(it);
+  DCHECK(link != registry.links.end());
+  if (link->second->AddClients(-1) == 0)
+    registry.links.erase(link);
+}
+
+// static
+scoped_refptr<DevToolsNetworkLink> DevToolsNetworkLink::Find(
+    const std::string& name) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  LinkRegistry& registry = g_registry.Get();
+  auto it = registry.links.find(name);
+  if (it == registry.links.end())
+    return nullptr;
+  return it->second;
+}
+
+DevToolsNetworkLink::DevToolsNetworkLink(const std::string& name)
+    : name_(name),
+      offline_(false) {
+}
+
+DevToolsNetworkLink::~DevToolsNetworkLink() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  DCHECK(controllers_.empty());
+  if (interceptor_)
+    DevToolsNetworkInterceptor::DeleteWhenIdle(std::move(interceptor_));
+}
+
+DevToolsNetworkInterceptor* DevToolsNetworkLink::GetInterceptor() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+
+  if (!interceptor_) {
+    interceptor_ = DevToolsNetworkController::CreateInterceptor();
+    interceptor_->SetThrottleObserver(
+        base::Bind(&DevToolsNetworkLink::OnThrottle, base::Unretained(this)));
+  }
+  return interceptor_.get();
+}
+
+void DevToolsNetworkLink::UpdateConditions(
+    std::unique_ptr<DevToolsNetworkConditions> conditions) {
+  DevToolsNetworkInterceptor* interceptor = GetInterceptor();
+  interceptor->UpdateConditions(std::move(conditions));
+  if (offline_ == interceptor->IsOffline())
+    return;
+
+  offline_ = !offline_;
+  for (DevToolsNetworkController* controller : controllers_)
+    controller->OnLinkOfflineChanged(offline_);
+}
+
+void DevToolsNetworkLink::AddController(
+    DevToolsNetworkController* controller) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  DCHECK(std::find(controllers_.begin(), controllers_.end(), controller) ==
+         controllers_.end());
+  controllers_.push_back(controller);
+}
+
+void DevToolsNetworkLink::RemoveController(
+    DevToolsNetworkController* controller) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  auto it = std::find(controllers_.begin(), controllers_.end(), controller);
+  DCHECK(it != controllers_.end());
+  controllers_.erase(it);
+}
+
+DevToolsNetworkLink::Stats DevToolsNetworkLink::GetStats() const {
+  base::AutoLock auto_lock(lock_);
+  return stats_;
+}
+
+int DevToolsNetworkLink::AddClients(int count) {
+  base::AutoLock auto_lock(lock_);
+  stats_.clients += count;
+  return stats_.clients;
+}
+
+void DevToolsNetworkLink::OnThrottle(int result, bool start, bool is_upload) {
+  base::AutoLock auto_lock(lock_);
+  if (start)
+    ++stats_.transactions;
+  if (is_upload)
+    stats_.upload_bytes += result;
+  else
+    stats_.download_bytes += result;
+}
+
+}  // namespace brightray
@@ -0,0 +1,97 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_DEVTOOLS_NETWORK_LINK_H_
+#define BROWSER_DEVTOOLS_NETWORK_LINK_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "content/public/browser/browser_thread.h"
+
+namespace brightray {
+
+class DevToolsNetworkConditions;
+class DevToolsNetworkController;
+class DevToolsNetworkInterceptor;
+
+// A named link shared by several DevTools clients, which may live in
+// different browser contexts. The transactions of all the clients go through
+// one interceptor, so they compete for the same bandwidth.
+class DevToolsNetworkLink
+    : public base::RefCountedThreadSafe<
+          DevToolsNetworkLink,
+          content::BrowserThread::DeleteOnIOThread> {
+ public:
+  struct Stats {
+    Stats();
+
+    int clients;
+    int64_t transactions;
+    // Payload bytes, headers are not included.
+    int64_t download_bytes;
+    int64_t upload_bytes;
+  };
+
+  // Called on the UI thread. Attaches |client_id| to the link named |name|,
+  // creating it if needed, and detaches the client from its previous link.
+  static scoped_refptr<DevToolsNetworkLink> Attach(
+      const std::string& name, const std::string& client_id);
+
+  // Called on the UI thread. The link is forgotten once its last client has
+  // been detached.
+  static void Detach(const std::string& client_id);
+
+  // Called on the UI thread, returns nullptr for unknown links.
+  static scoped_refptr<DevToolsNetworkLink> Find(const std::string& name);
+
+  const std::string& name() const { return name_; }
+
+  // Called on the IO thread.
+  DevToolsNetworkInterceptor* GetInterceptor();
+
+  // Called on the IO thread. The controllers whose clients are attached to
+  // the link are told when it goes offline or back online.
+  void UpdateConditions(std::unique_ptr<DevToolsNetworkConditions> conditions);
+  bool IsOffline() const { return offline_; }
+  void AddController(DevToolsNetworkController* controller);
+  void RemoveController(DevToolsNetworkController* controller);
+
+  // Can be called on any thread.
+  Stats GetStats() const;
+
+ private:
+  friend struct content::BrowserThread::DeleteOnThread<
+      content::BrowserThread::IO>;
+  friend class base::DeleteHelper<DevToolsNetworkLink>;
+
+  explicit DevToolsNetworkLink(const std::string& name);
+  ~DevToolsNetworkLink();
+
+  // Returns the number of clients left.
+  int AddClients(int count);
+  void OnThrottle(int result, bool start, bool is_upload);
+
+  const std::string name_;
+  std::unique_ptr<DevToolsNetworkInterceptor> interceptor_;
+
+  // Only used on the IO thread.
+  std::vector<DevToolsNetworkController*> controllers_;
+  bool offline_;
+
+  mutable base::Lock lock_;
+  Stats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkLink);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_DEVTOOLS_NETWORK_LINK_H_
@@ -0,0 +1,84 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_presets.h"
+
+#include <memory>
+#include <utility>
+
+#include "base/json/json_reader.h"
+
+namespace brightray {
+
+namespace {
+
+// One-way latencies in milliseconds and throughputs in kbit/s, the typical
+// figures of each connection type.
+const struct {
+  const char* name;
+  double download_latency;
+  double upload_latency;
+  double download_kbps;
+  double upload_kbps;
+} kBuiltInPresets[] = {
+  { "2g", 150, 150, 250, 50 },
+  { "3g", 50, 50, 750, 250 },
+  { "4g", 10, 10, 4 * 1024, 3 * 1024 },
+  { "lte", 25, 25, 12 * 1024, 5 * 1024 },
+  { "satellite", 300, 300, 25 * 1024, 3 * 1024 },
+  { "wifi", 1, 1, 30 * 1024, 15 * 1024 },
+};
+
+// The protocol takes throughputs in bytes per second.
+double ToBytesPerSecond(double kbps) {
+  return kbps * 1024 / 8;
+}
+
+}  // namespace
+
+DevToolsNetworkPresets::DevToolsNetworkPresets() {
+  for (const auto& preset : kBuiltInPresets) {
+    std::unique_ptr<base::DictionaryValue> params(new base::DictionaryValue);
+    params->SetBoolean("offline", false);
+    params->SetDouble("downloadLatency", preset.download_latency);
+    params->SetDouble("uploadLatency", preset.upload_latency);
+    params->SetDouble("downloadThroughput",
+                      ToBytesPerSecond(preset.download_kbps));
+    params->SetDouble("uploadThroughput",
+                      ToBytesPerSecond(preset.upload_kbps));
+    presets_.SetWithoutPathExpansion(preset.name, std::move(params));
+  }
+}
+
+DevToolsNetworkPresets::~DevToolsNetworkPresets() {
+}
+
+bool DevToolsNetworkPresets::AddFromJSON(const std::string& json) {
+  std::unique_ptr<base::DictionaryValue> profile =
+      base::DictionaryValue::From(base::JSONReader::Read(json));
+  if (!profile)
+    return false;
+
+  for (base::DictionaryValue::Iterator it(*profile); !it.IsAtEnd();
+       it.Advance()) {
+    const base::DictionaryValue* params = nullptr;
+    if (!it.value().GetAsDictionary(&params))
+      return false;
+  }
+  for (base::DictionaryValue::Iterator it(*profile); !it.IsAtEnd();
+       it.Advance()) {
+    presets_.SetWithoutPathExpansion(it.key(), it.value().CreateDeepCopy());
+  }
+  return true;
+}
+
+const base::DictionaryValue* DevToolsNetworkPresets::Find(
+    const std::string& name) const {
+  const base::DictionaryValue* preset = nullptr;
+  if (!presets_.GetDictionaryWithoutPathExpansion(name, &preset))
+    return nullptr;
+  return preset;
+}
+
+}  // namespace brightray
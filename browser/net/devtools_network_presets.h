@@ -0,0 +1,44 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_DEVTOOLS_NETWORK_PRESETS_H_
+#define BROWSER_DEVTOOLS_NETWORK_PRESETS_H_
+
+#include <string>
+
+#include "base/macros.h"
+#include "base/values.h"
+
+namespace brightray {
+
+// Named connection types, each one a set of Network.emulateNetworkConditions
+// parameters. The built-in presets can be extended or replaced by a JSON
+// profile of the same shape:
+//
+//   { "edge": { "downloadLatency": 200, "uploadLatency": 200,
+//               "downloadThroughput": 30000, "uploadThroughput": 15000 } }
+class DevToolsNetworkPresets {
+ public:
+  DevToolsNetworkPresets();
+  ~DevToolsNetworkPresets();
+
+  // Adds the presets of a JSON profile, replacing those with the same name.
+  // Returns false and keeps the current presets when |json| is not an object
+  // of objects.
+  bool AddFromJSON(const std::string& json);
+
+  // Returns nullptr for an unknown preset.
+  const base::DictionaryValue* Find(const std::string& name) const;
+
+  const base::DictionaryValue& presets() const { return presets_; }
+
+ private:
+  base::DictionaryValue presets_;
+
+  DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkPresets);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_DEVTOOLS_NETWORK_PRESETS_H_
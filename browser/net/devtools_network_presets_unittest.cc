@@ -0,0 +1,58 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_presets.h"
+
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brightray {
+
+TEST(DevToolsNetworkPresetsTest, BuiltInPresets) {
+  DevToolsNetworkPresets presets;
+  const base::DictionaryValue* preset = presets.Find("3g");
+  ASSERT_TRUE(preset);
+  double throughput = 0;
+  EXPECT_TRUE(preset->GetDouble("downloadThroughput", &throughput));
+  EXPECT_EQ(750 * 1024 / 8, throughput);
+  EXPECT_FALSE(presets.Find("edge"));
+}
+
+TEST(DevToolsNetworkPresetsTest, AddFromJSON) {
+  DevToolsNetworkPresets presets;
+  EXPECT_TRUE(presets.AddFromJSON(
+      "{ \"edge\": { \"downloadLatency\": 200 },"
+      "  \"3g\": { \"downloadLatency\": 400 } }"));
+
+  double latency = 0;
+  const base::DictionaryValue* edge = presets.Find("edge");
+  ASSERT_TRUE(edge);
+  EXPECT_TRUE(edge->GetDouble("downloadLatency", &latency));
+  EXPECT_EQ(200, latency);
+
+  // A preset of the same name is replaced, not merged.
+  const base::DictionaryValue* replaced = presets.Find("3g");
+  ASSERT_TRUE(replaced);
+  EXPECT_TRUE(replaced->GetDouble("downloadLatency", &latency));
+  EXPECT_EQ(400, latency);
+  EXPECT_FALSE(replaced->HasKey("downloadThroughput"));
+
+  EXPECT_TRUE(presets.Find("wifi"));
+}
+
+TEST(DevToolsNetworkPresetsTest, AddFromInvalidJSON) {
+  DevToolsNetworkPresets presets;
+  size_t size = presets.presets().size();
+
+  EXPECT_FALSE(presets.AddFromJSON("not json"));
+  EXPECT_FALSE(presets.AddFromJSON("[]"));
+  // Nothing is added when one of the presets is invalid.
+  EXPECT_FALSE(presets.AddFromJSON(
+      "{ \"edge\": { \"downloadLatency\": 200 }, \"bad\": 1 }"));
+
+  EXPECT_EQ(size, presets.presets().size());
+  EXPECT_FALSE(presets.Find("edge"));
+}
+
+}  // namespace brightray
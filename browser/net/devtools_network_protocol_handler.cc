@@ -4,13 +4,28 @@
 
 #include "browser/net/devtools_network_protocol_handler.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "browser/browser_context.h"
 #include "browser/net/devtools_network_conditions.h"
 #include "browser/net/devtools_network_controller.h"
-
+#include "browser/net/devtools_network_link.h"
+#include "browser/net/devtools_network_rules.h"
+#include "browser/net/devtools_network_stats.h"
+#include "browser/net/devtools_network_trace.h"
+#include "common/switches.h"
+
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
+#include "base/task_runner_util.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/devtools_agent_host.h"
+#include "content/public/common/resource_type.h"
 
 
 namespace brightray {
@@ -19,10 +34,50 @@ namespace {
 
 namespace params {
 
+const char kBandwidthTime[] = "bandwidthTime";
+const char kBlock[] = "block";
+const char kBytes[] = "bytes";
+const char kCancelled[] = "cancelled";
+const char kChunks[] = "chunks";
+const char kClients[] = "clients";
+const char kDownloadBytes[] = "downloadBytes";
+const char kDownloadLatency[] = "downloadLatency";
 const char kDownloadThroughput[] = "downloadThroughput";
+const char kDownloadTrace[] = "downloadTrace";
+const char kFailed[] = "failed";
+const char kFinished[] = "finished";
+const char kHost[] = "host";
+const char kInitialCongestionWindow[] = "initialCongestionWindow";
+const char kIsStart[] = "isStart";
+const char kIsUpload[] = "isUpload";
+const char kJitterDistribution[] = "jitterDistribution";
 const char kLatency[] = "latency";
+const char kLatencyJitter[] = "latencyJitter";
+const char kLatencyTime[] = "latencyTime";
+const char kLink[] = "link";
 const char kOffline[] = "offline";
+const char kPacketLoss[] = "packetLoss";
+const char kPreset[] = "preset";
+const char kPresets[] = "presets";
+const char kQueued[] = "queued";
+const char kReleased[] = "released";
+const char kResourceTypes[] = "resourceTypes";
+const char kRetransmissionTimeout[] = "retransmissionTimeout";
+const char kRules[] = "rules";
+const char kSeed[] = "seed";
+const char kThroughputVariance[] = "throughputVariance";
+const char kThroughputVariancePeriod[] = "throughputVariancePeriod";
+const char kTimeline[] = "timeline";
+const char kTraceLoadFailures[] = "traceLoadFailures";
+const char kTraceLoop[] = "traceLoop";
+const char kTransactionId[] = "transactionId";
+const char kTransactions[] = "transactions";
+const char kUnthrottledWebSockets[] = "unthrottledWebSockets";
+const char kUploadBytes[] = "uploadBytes";
+const char kUploadLatency[] = "uploadLatency";
 const char kUploadThroughput[] = "uploadThroughput";
+const char kUploadTrace[] = "uploadTrace";
+const char kUrlPattern[] = "urlPattern";
 const char kResult[] = "result";
 const char kErrorCode[] = "code";
 const char kErrorMessage[] = "message";
@@ -32,6 +87,10 @@ const char kErrorMessage[] = "message";
 const char kEmulateNetworkConditions[] = "Network.emulateNetworkConditions";
 const char kCanEmulateNetworkConditions[] =
     "Network.canEmulateNetworkConditions";
+const char kGetEmulatedLinkStats[] = "Network.getEmulatedLinkStats";
+const char kSetEmulationRules[] = "Network.setEmulationRules";
+const char kGetThrottlingStats[] = "Network.getThrottlingStats";
+const char kGetEmulationPresets[] = "Network.getEmulationPresets";
 const char kId[] = "id";
 const char kMethod[] = "method";
 const char kParams[] = "params";
@@ -39,6 +98,41 @@ const char kError[] = "error";
 // JSON RPC 2.0 spec: http://www.jsonrpc.org/specification#error_object
 const int kErrorInvalidParams = -32602;
 
+// DevTools resource types and the content::ResourceType they cover.
+const struct {
+  const char* name;
+  content::ResourceType type;
+} kResourceTypes[] = {
+  { "Document", content::RESOURCE_TYPE_MAIN_FRAME },
+  { "Document", content::RESOURCE_TYPE_SUB_FRAME },
+  { "Stylesheet", content::RESOURCE_TYPE_STYLESHEET },
+  { "Script", content::RESOURCE_TYPE_SCRIPT },
+  { "Image", content::RESOURCE_TYPE_IMAGE },
+  { "Image", content::RESOURCE_TYPE_FAVICON },
+  { "Font", content::RESOURCE_TYPE_FONT_RESOURCE },
+  { "Media", content::RESOURCE_TYPE_MEDIA },
+  { "XHR", content::RESOURCE_TYPE_XHR },
+  { "Ping", content::RESOURCE_TYPE_PING },
+  { "Other", content::RESOURCE_TYPE_SUB_RESOURCE },
+  { "Other", content::RESOURCE_TYPE_OBJECT },
+  { "Other", content::RESOURCE_TYPE_WORKER },
+  { "Other", content::RESOURCE_TYPE_SHARED_WORKER },
+  { "Other", content::RESOURCE_TYPE_PREFETCH },
+  { "Other", content::RESOURCE_TYPE_SERVICE_WORKER },
+  { "Other", content::RESOURCE_TYPE_CSP_REPORT },
+  { "Other", content::RESOURCE_TYPE_PLUGIN_RESOURCE },
+};
+
+// Used when packet loss is emulated without an explicit timeout, this is the
+// minimum retransmission timeout of most TCP stacks.
+const double kDefaultRetransmissionTimeout = 200;
+
+// How often the throughput changes by default when it varies.
+const double kDefaultThroughputVariancePeriod = 1000;
+
+// Largest seed a JSON number holds exactly, bigger ones are passed as strings.
+const double kMaxNumberSeed = 9007199254740992.0;  // 2^53
+
 
 bool ParseCommand(const base::DictionaryValue* command,
                   int* id,
@@ -78,9 +172,205 @@ CreateFailureResponse(int id, const std::string& param) {
   return response;
 }
 
+bool ParseJitterDistribution(
+    const std::string& name,
+    DevToolsNetworkConditions::JitterDistribution* distribution) {
+  if (name == "uniform")
+    *distribution = DevToolsNetworkConditions::JITTER_UNIFORM;
+  else if (name == "normal")
+    *distribution = DevToolsNetworkConditions::JITTER_NORMAL;
+  else if (name == "pareto")
+    *distribution = DevToolsNetworkConditions::JITTER_PARETO;
+  else
+    return false;
+  return true;
+}
+
+// Reads the optional variance model, returns the name of the first invalid
+// parameter or nullptr.
+const char* ParseVarianceModel(const base::DictionaryValue* params,
+                               DevToolsNetworkConditions* conditions) {
+  double jitter = 0.0;
+  if (params->GetDouble(params::kLatencyJitter, &jitter) && jitter > 0.0) {
+    auto distribution = DevToolsNetworkConditions::JITTER_UNIFORM;
+    std::string name;
+    if (params->GetString(params::kJitterDistribution, &name) &&
+        !ParseJitterDistribution(name, &distribution)) {
+      return params::kJitterDistribution;
+    }
+    conditions->set_latency_jitter(jitter, distribution);
+  }
+
+  double packet_loss = 0.0;
+  if (params->GetDouble(params::kPacketLoss, &packet_loss) &&
+      packet_loss > 0.0) {
+    if (packet_loss > 1.0)
+      return params::kPacketLoss;
+    double timeout = kDefaultRetransmissionTimeout;
+    if (params->GetDouble(params::kRetransmissionTimeout, &timeout) &&
+        timeout < 0.0) {
+      return params::kRetransmissionTimeout;
+    }
+    conditions->set_packet_loss(packet_loss, timeout);
+  }
+
+  double variance = 0.0;
+  if (params->GetDouble(params::kThroughputVariance, &variance) &&
+      variance > 0.0) {
+    if (variance > 1.0)
+      return params::kThroughputVariance;
+    double period = kDefaultThroughputVariancePeriod;
+    if (params->GetDouble(params::kThroughputVariancePeriod, &period) &&
+        period <= 0.0) {
+      return params::kThroughputVariancePeriod;
+    }
+    conditions->set_throughput_variance(variance, period);
+  }
+
+  int congestion_window = 0;
+  if (params->GetInteger(params::kInitialCongestionWindow,
+                         &congestion_window)) {
+    if (congestion_window < 0)
+      return params::kInitialCongestionWindow;
+    conditions->set_initial_congestion_window(congestion_window);
+  }
+
+  // A decimal string covers the whole 64 bits of the seed.
+  const base::Value* seed_value = nullptr;
+  if (params->Get(params::kSeed, &seed_value)) {
+    uint64_t seed = 0;
+    std::string seed_string;
+    double seed_number = 0.0;
+    if (seed_value->GetAsString(&seed_string)) {
+      if (!base::StringToUint64(seed_string, &seed))
+        return params::kSeed;
+    } else if (seed_value->GetAsDouble(&seed_number)) {
+      if (seed_number < 0.0 || seed_number > kMaxNumberSeed ||
+          seed_number != std::floor(seed_number)) {
+        return params::kSeed;
+      }
+      seed = static_cast<uint64_t>(seed_number);
+    } else {
+      return params::kSeed;
+    }
+    conditions->set_seed(seed);
+  }
+
+  return nullptr;
+}
+
+bool ParseResourceTypes(const base::ListValue* names,
+                        std::vector<int>* types) {
+  for (size_t i = 0; i < names->GetSize(); ++i) {
+    std::string name;
+    if (!names->GetString(i, &name))
+      return false;
+    bool found = false;
+    for (const auto& resource_type : kResourceTypes) {
+      if (name == resource_type.name) {
+        types->push_back(resource_type.type);
+        found = true;
+      }
+    }
+    if (!found)
+      return false;
+  }
+  return true;
+}
+
+// Reads one entry of Network.setEmulationRules, returns the name of the first
+// invalid parameter or nullptr.
+const char* ParseRule(const base::DictionaryValue* params,
+                      DevToolsNetworkRules::Rule* rule) {
+  params->GetString(params::kHost, &rule->host);
+  params->GetString(params::kUrlPattern, &rule->url_pattern);
+  const base::ListValue* resource_types = nullptr;
+  if (params->GetList(params::kResourceTypes, &resource_types) &&
+      !ParseResourceTypes(resource_types, &rule->resource_types)) {
+    return params::kResourceTypes;
+  }
+  params->GetBoolean(params::kBlock, &rule->block);
+
+  // Requests matching a rule without conditions are not throttled.
+  bool offline = false;
+  double latency = 0.0;
+  double download_throughput = 0.0;
+  double upload_throughput = 0.0;
+  bool has_conditions = params->GetBoolean(params::kOffline, &offline);
+  has_conditions |= params->GetDouble(params::kLatency, &latency);
+  has_conditions |= params->GetDouble(params::kDownloadThroughput,
+                                      &download_throughput);
+  has_conditions |= params->GetDouble(params::kUploadThroughput,
+                                      &upload_throughput);
+  if (!has_conditions)
+    return nullptr;
+
+  rule->conditions.reset(new DevToolsNetworkConditions(
+      offline,
+      std::max(latency, 0.0),
+      std::max(download_throughput, 0.0),
+      std::max(upload_throughput, 0.0)));
+  return ParseVarianceModel(params, rule->conditions.get());
+}
+
+}  // namespace
+
+struct DevToolsNetworkTraces {
+  bool succeeded = true;
+  scoped_refptr<DevToolsNetworkTrace> download;
+  scoped_refptr<DevToolsNetworkTrace> upload;
+};
+
+namespace {
+
+DevToolsNetworkTraces LoadTraces(const base::FilePath& download_path,
+                                 const base::FilePath& upload_path) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::FILE);
+
+  DevToolsNetworkTraces traces;
+  if (!download_path.empty()) {
+    traces.download = DevToolsNetworkTrace::LoadFromFile(download_path);
+    if (!traces.download) {
+      LOG(ERROR) << "Invalid network trace: " << download_path.value();
+      traces.succeeded = false;
+    }
+  }
+  if (!upload_path.empty()) {
+    traces.upload = DevToolsNetworkTrace::LoadFromFile(upload_path);
+    if (!traces.upload) {
+      LOG(ERROR) << "Invalid network trace: " << upload_path.value();
+      traces.succeeded = false;
+    }
+  }
+  return traces;
+}
+
+std::string ReadPresets(const base::FilePath& path) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::FILE);
+
+  std::string json;
+  if (!base::ReadFileToString(path, &json))
+    LOG(ERROR) << "Failed to read network presets: " << path.value();
+  return json;
+}
+
 }  // namespace
 
-DevToolsNetworkProtocolHandler::DevToolsNetworkProtocolHandler() {
+DevToolsNetworkProtocolHandler::DevToolsNetworkProtocolHandler()
+    : next_trace_load_(0),
+      weak_factory_(this) {
+  auto command_line = base::CommandLine::ForCurrentProcess();
+  base::FilePath path =
+      command_line->GetSwitchValuePath(switches::kDevToolsNetworkPresets);
+  if (!path.empty()) {
+    base::PostTaskAndReplyWithResult(
+        content::BrowserThread::GetTaskRunnerForThread(
+            content::BrowserThread::FILE).get(),
+        FROM_HERE,
+        base::Bind(&ReadPresets, path),
+        base::Bind(&DevToolsNetworkProtocolHandler::OnPresetsLoaded,
+                   weak_factory_.GetWeakPtr()));
+  }
 }
 
 DevToolsNetworkProtocolHandler::~DevToolsNetworkProtocolHandler() {
@@ -102,6 +392,18 @@ base::DictionaryValue* DevToolsNetworkProtocolHandler::HandleCommand(
   if (method == kCanEmulateNetworkConditions)
     return CanEmulateNetworkConditions(agent_host, id, params).release();
 
+  if (method == kGetEmulatedLinkStats)
+    return GetEmulatedLinkStats(agent_host, id, params).release();
+
+  if (method == kSetEmulationRules)
+    return SetEmulationRules(agent_host, id, params).release();
+
+  if (method == kGetThrottlingStats)
+    return GetThrottlingStats(agent_host, id, params).release();
+
+  if (method == kGetEmulationPresets)
+    return GetEmulationPresets(agent_host, id, params).release();
+
   return nullptr;
 }
 
@@ -111,7 +413,11 @@ void DevToolsNetworkProtocolHandler::DevToolsAgentStateChanged(
   std::unique_ptr<DevToolsNetworkConditions> conditions;
   if (attached)
     conditions.reset(new DevToolsNetworkConditions(false));
-  UpdateNetworkState(agent_host, std::move(conditions));
+  else
+    stats_.erase(agent_host->GetId());
+  trace_loads_.erase(agent_host->GetId());
+  DevToolsNetworkLink::Detach(agent_host->GetId());
+  UpdateNetworkState(agent_host, nullptr, std::move(conditions));
 }
 
 std::unique_ptr<base::DictionaryValue>
@@ -129,13 +435,45 @@ DevToolsNetworkProtocolHandler::EmulateNetworkConditions(
     content::DevToolsAgentHost* agent_host,
     int id,
     const base::DictionaryValue* params) {
+  // A preset fills in the parameters left out of the command.
+  std::unique_ptr<base::DictionaryValue> preset_params;
+  std::string preset_name;
+  if (params && params->GetString(params::kPreset, &preset_name)) {
+    const base::DictionaryValue* preset = presets_.Find(preset_name);
+    if (!preset)
+      return CreateFailureResponse(id, params::kPreset);
+    preset_params = preset->CreateDeepCopy();
+    if (!preset_params->HasKey(params::kOffline))
+      preset_params->SetBoolean(params::kOffline, false);
+    // A round trip latency replaces the one-way latencies of the preset.
+    if (params->HasKey(params::kLatency)) {
+      preset_params->Remove(params::kDownloadLatency, nullptr);
+      preset_params->Remove(params::kUploadLatency, nullptr);
+    }
+    preset_params->MergeDictionary(params);
+    params = preset_params.get();
+  }
+
   bool offline = false;
   if (!params || !params->GetBoolean(params::kOffline, &offline))
     return CreateFailureResponse(id, params::kOffline);
 
+  // The latency is either a round trip or split between the two directions,
+  // in which case request bodies wait for the uplink part.
   double latency = 0.0;
-  if (!params->GetDouble(params::kLatency, &latency))
+  double download_latency = 0.0;
+  double upload_latency = 0.0;
+  bool has_download_latency =
+      params->GetDouble(params::kDownloadLatency, &download_latency);
+  bool has_upload_latency =
+      params->GetDouble(params::kUploadLatency, &upload_latency);
+  if (has_download_latency || has_upload_latency) {
+    download_latency = std::max(download_latency, 0.0);
+    upload_latency = std::max(upload_latency, 0.0);
+    latency = download_latency + upload_latency;
+  } else if (!params->GetDouble(params::kLatency, &latency)) {
     return CreateFailureResponse(id, params::kLatency);
+  }
   if (latency < 0.0)
     latency = 0.0;
 
@@ -156,17 +494,223 @@ DevToolsNetworkProtocolHandler::EmulateNetworkConditions(
                                     latency,
                                     download_throughput,
                                     upload_throughput));
-  UpdateNetworkState(agent_host, std::move(conditions));
+  conditions->set_upload_latency(upload_latency);
+  const char* invalid_param = ParseVarianceModel(params, conditions.get());
+  if (invalid_param)
+    return CreateFailureResponse(id, invalid_param);
+
+  std::string link_name;
+  params->GetString(params::kLink, &link_name);
+
+  // Traces are read on the FILE thread, the conditions apply once they have
+  // been loaded. A later command of the client supersedes the pending one.
+  std::string download_trace;
+  std::string upload_trace;
+  params->GetString(params::kDownloadTrace, &download_trace);
+  params->GetString(params::kUploadTrace, &upload_trace);
+  if (!download_trace.empty() || !upload_trace.empty()) {
+    bool loop = true;
+    params->GetBoolean(params::kTraceLoop, &loop);
+    uint64_t trace_load = ++next_trace_load_;
+    trace_loads_[agent_host->GetId()] = trace_load;
+    base::PostTaskAndReplyWithResult(
+        content::BrowserThread::GetTaskRunnerForThread(
+            content::BrowserThread::FILE).get(),
+        FROM_HERE,
+        base::Bind(&LoadTraces,
+                   base::FilePath::FromUTF8Unsafe(download_trace),
+                   base::FilePath::FromUTF8Unsafe(upload_trace)),
+        base::Bind(&DevToolsNetworkProtocolHandler::OnTracesLoaded,
+                   weak_factory_.GetWeakPtr(),
+                   make_scoped_refptr(agent_host),
+                   trace_load,
+                   link_name,
+                   loop,
+                   base::Passed(&conditions)));
+    return std::unique_ptr<base::DictionaryValue>();
+  }
+
+  trace_loads_.erase(agent_host->GetId());
+  ApplyNetworkConditions(agent_host, link_name, std::move(conditions));
   return std::unique_ptr<base::DictionaryValue>();
 }
 
+std::unique_ptr<base::DictionaryValue>
+DevToolsNetworkProtocolHandler::GetEmulatedLinkStats(
+    content::DevToolsAgentHost* agent_host,
+    int id,
+    const base::DictionaryValue* params) {
+  std::string link_name;
+  if (!params || !params->GetString(params::kLink, &link_name))
+    return CreateFailureResponse(id, params::kLink);
+
+  scoped_refptr<DevToolsNetworkLink> link =
+      DevToolsNetworkLink::Find(link_name);
+  if (!link)
+    return CreateFailureResponse(id, params::kLink);
+
+  DevToolsNetworkLink::Stats stats = link->GetStats();
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue);
+  result->SetInteger(params::kClients, stats.clients);
+  result->SetDouble(params::kTransactions, stats.transactions);
+  result->SetDouble(params::kDownloadBytes, stats.download_bytes);
+  result->SetDouble(params::kUploadBytes, stats.upload_bytes);
+  return CreateSuccessResponse(id, std::move(result));
+}
+
+std::unique_ptr<base::DictionaryValue>
+DevToolsNetworkProtocolHandler::SetEmulationRules(
+    content::DevToolsAgentHost* agent_host,
+    int id,
+    const base::DictionaryValue* params) {
+  const base::ListValue* rule_list = nullptr;
+  if (!params || !params->GetList(params::kRules, &rule_list))
+    return CreateFailureResponse(id, params::kRules);
+
+  // An empty list removes the rules.
+  std::unique_ptr<DevToolsNetworkRules> rules;
+  if (!rule_list->empty())
+    rules.reset(new DevToolsNetworkRules);
+  for (size_t i = 0; i < rule_list->GetSize(); ++i) {
+    const base::DictionaryValue* rule_params = nullptr;
+    if (!rule_list->GetDictionary(i, &rule_params))
+      return CreateFailureResponse(id, params::kRules);
+    std::unique_ptr<DevToolsNetworkRules::Rule> rule(
+        new DevToolsNetworkRules::Rule);
+    const char* invalid_param = ParseRule(rule_params, rule.get());
+    if (invalid_param)
+      return CreateFailureResponse(id, invalid_param);
+    if (rule->conditions)
+      rule->conditions->set_stats(GetStats(agent_host));
+    rules->AddRule(std::move(rule));
+  }
+
+  auto browser_context =
+      static_cast<brightray::BrowserContext*>(agent_host->GetBrowserContext());
+  browser_context->network_controller_handle()->SetRules(
+      agent_host->GetId(), std::move(rules));
+  return CreateSuccessResponse(
+      id, std::unique_ptr<base::DictionaryValue>(new base::DictionaryValue));
+}
+
+std::unique_ptr<base::DictionaryValue>
+DevToolsNetworkProtocolHandler::GetThrottlingStats(
+    content::DevToolsAgentHost* agent_host,
+    int id,
+    const base::DictionaryValue* params) {
+  DevToolsNetworkStats* stats = GetStats(agent_host);
+  DevToolsNetworkStats::Counters counters = stats->GetCounters();
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue);
+  result->SetDouble(params::kTransactions, counters.transactions);
+  result->SetDouble(params::kChunks, counters.chunks);
+  result->SetDouble(params::kDownloadBytes, counters.download_bytes);
+  result->SetDouble(params::kUploadBytes, counters.upload_bytes);
+  result->SetDouble(params::kFailed, counters.failed);
+  result->SetDouble(params::kCancelled, counters.cancelled);
+  result->SetDouble(params::kUnthrottledWebSockets,
+                    counters.unthrottled_websockets);
+  result->SetDouble(params::kTraceLoadFailures, counters.trace_load_failures);
+  result->SetDouble(params::kLatencyTime,
+                    counters.latency_time.InMillisecondsF());
+  result->SetDouble(params::kBandwidthTime,
+                    counters.bandwidth_time.InMillisecondsF());
+
+  // Times are in milliseconds on the monotonic clock, a chunk not released
+  // was cancelled or failed while waiting for its latency.
+  std::unique_ptr<base::ListValue> timeline(new base::ListValue);
+  for (const auto& entry : stats->GetTimeline()) {
+    std::unique_ptr<base::DictionaryValue> value(new base::DictionaryValue);
+    value->SetDouble(params::kTransactionId, entry.transaction_id);
+    value->SetBoolean(params::kIsStart, entry.is_start);
+    value->SetBoolean(params::kIsUpload, entry.is_upload);
+    value->SetDouble(params::kBytes, entry.bytes);
+    value->SetInteger(params::kResult, entry.result);
+    value->SetDouble(params::kQueued,
+                     (entry.queued - base::TimeTicks()).InMillisecondsF());
+    if (!entry.released.is_null()) {
+      value->SetDouble(params::kReleased,
+                       (entry.released - base::TimeTicks()).InMillisecondsF());
+    }
+    value->SetDouble(params::kFinished,
+                     (entry.finished - base::TimeTicks()).InMillisecondsF());
+    timeline->Append(std::move(value));
+  }
+  result->Set(params::kTimeline, std::move(timeline));
+  return CreateSuccessResponse(id, std::move(result));
+}
+
+std::unique_ptr<base::DictionaryValue>
+DevToolsNetworkProtocolHandler::GetEmulationPresets(
+    content::DevToolsAgentHost* agent_host,
+    int id,
+    const base::DictionaryValue* params) {
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue);
+  result->Set(params::kPresets, presets_.presets().CreateDeepCopy());
+  return CreateSuccessResponse(id, std::move(result));
+}
+
+DevToolsNetworkStats* DevToolsNetworkProtocolHandler::GetStats(
+    content::DevToolsAgentHost* agent_host) {
+  scoped_refptr<DevToolsNetworkStats>& stats = stats_[agent_host->GetId()];
+  if (!stats)
+    stats = new DevToolsNetworkStats;
+  return stats.get();
+}
+
+void DevToolsNetworkProtocolHandler::ApplyNetworkConditions(
+    content::DevToolsAgentHost* agent_host,
+    const std::string& link_name,
+    std::unique_ptr<DevToolsNetworkConditions> conditions) {
+  // Clients attached to the same link share its bandwidth, the last
+  // conditions emulated on a link apply to all of them.
+  scoped_refptr<DevToolsNetworkLink> link;
+  if (!link_name.empty())
+    link = DevToolsNetworkLink::Attach(link_name, agent_host->GetId());
+  else
+    DevToolsNetworkLink::Detach(agent_host->GetId());
+
+  UpdateNetworkState(agent_host, link, std::move(conditions));
+}
+
+void DevToolsNetworkProtocolHandler::OnTracesLoaded(
+    scoped_refptr<content::DevToolsAgentHost> agent_host,
+    uint64_t trace_load,
+    const std::string& link_name,
+    bool loop,
+    std::unique_ptr<DevToolsNetworkConditions> conditions,
+    const DevToolsNetworkTraces& traces) {
+  // Superseded by a later command, or the client is gone.
+  auto it = trace_loads_.find(agent_host->GetId());
+  if (it == trace_loads_.end() || it->second != trace_load)
+    return;
+  trace_loads_.erase(it);
+
+  // Keep the previous conditions rather than emulating half of a link, the
+  // client sees the failure in Network.getThrottlingStats.
+  if (!traces.succeeded) {
+    GetStats(agent_host.get())->AddTraceLoadFailure();
+    return;
+  }
+
+  conditions->set_traces(traces.download, traces.upload, loop);
+  ApplyNetworkConditions(agent_host.get(), link_name, std::move(conditions));
+}
+
+void DevToolsNetworkProtocolHandler::OnPresetsLoaded(const std::string& json) {
+  if (!json.empty() && !presets_.AddFromJSON(json))
+    LOG(ERROR) << "Invalid network presets";
+}
+
 void DevToolsNetworkProtocolHandler::UpdateNetworkState(
     content::DevToolsAgentHost* agent_host,
+    scoped_refptr<DevToolsNetworkLink> link,
     std::unique_ptr<DevToolsNetworkConditions> conditions) {
+  if (conditions)
+    conditions->set_stats(GetStats(agent_host));
   auto browser_context =
       static_cast<brightray::BrowserContext*>(agent_host->GetBrowserContext());
   browser_context->network_controller_handle()->SetNetworkState(
-      agent_host->GetId(), std::move(conditions));
+      agent_host->GetId(), link, std::move(conditions));
 }
 
 }  // namespace brightray
@@ -5,8 +5,17 @@
 #ifndef BROWSER_DEVTOOLS_NETWORK_PROTOCOL_HANDLER_H_
 #define BROWSER_DEVTOOLS_NETWORK_PROTOCOL_HANDLER_H_
 
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
 #include "base/values.h"
+#include "browser/net/devtools_network_presets.h"
 
 namespace content {
 class DevToolsAgentHost;
@@ -15,6 +24,9 @@ class DevToolsAgentHost;
 namespace brightray {
 
 class DevToolsNetworkConditions;
+class DevToolsNetworkLink;
+class DevToolsNetworkStats;
+struct DevToolsNetworkTraces;
 
 class DevToolsNetworkProtocolHandler {
  public:
@@ -36,9 +48,50 @@ class DevToolsNetworkProtocolHandler {
       content::DevToolsAgentHost* agent_host,
       int command_id,
       const base::DictionaryValue* params);
+  std::unique_ptr<base::DictionaryValue> GetEmulatedLinkStats(
+      content::DevToolsAgentHost* agent_host,
+      int command_id,
+      const base::DictionaryValue* params);
+  std::unique_ptr<base::DictionaryValue> SetEmulationRules(
+      content::DevToolsAgentHost* agent_host,
+      int command_id,
+      const base::DictionaryValue* params);
+  std::unique_ptr<base::DictionaryValue> GetThrottlingStats(
+      content::DevToolsAgentHost* agent_host,
+      int command_id,
+      const base::DictionaryValue* params);
+  std::unique_ptr<base::DictionaryValue> GetEmulationPresets(
+      content::DevToolsAgentHost* agent_host,
+      int command_id,
+      const base::DictionaryValue* params);
+  DevToolsNetworkStats* GetStats(content::DevToolsAgentHost* agent_host);
   void UpdateNetworkState(
       content::DevToolsAgentHost* agent_host,
+      scoped_refptr<DevToolsNetworkLink> link,
+      std::unique_ptr<DevToolsNetworkConditions> conditions);
+  void ApplyNetworkConditions(
+      content::DevToolsAgentHost* agent_host,
+      const std::string& link_name,
       std::unique_ptr<DevToolsNetworkConditions> conditions);
+  void OnTracesLoaded(scoped_refptr<content::DevToolsAgentHost> agent_host,
+                      uint64_t trace_load,
+                      const std::string& link_name,
+                      bool loop,
+                      std::unique_ptr<DevToolsNetworkConditions> conditions,
+                      const DevToolsNetworkTraces& traces);
+  void OnPresetsLoaded(const std::string& json);
+
+  // Presets loaded after startup are only known to the commands that follow.
+  DevToolsNetworkPresets presets_;
+
+  // Throttling statistics by client id.
+  std::unordered_map<std::string, scoped_refptr<DevToolsNetworkStats>> stats_;
+
+  // Pending trace load of each client id, only the last one applies.
+  std::unordered_map<std::string, uint64_t> trace_loads_;
+  uint64_t next_trace_load_;
+
+  base::WeakPtrFactory<DevToolsNetworkProtocolHandler> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkProtocolHandler);
 };
@@ -0,0 +1,197 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_rules.h"
+
+#include <limits>
+
+#include "base/logging.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "browser/net/devtools_network_conditions.h"
+#include "browser/net/devtools_network_controller.h"
+#include "browser/net/devtools_network_interceptor.h"
+#include "url/gurl.h"
+
+namespace brightray {
+
+namespace {
+
+const size_t kNoRule = std::numeric_limits<size_t>::max();
+
+}  // namespace
+
+DevToolsNetworkRules::Rule::Rule() : block(false) {
+}
+
+DevToolsNetworkRules::Rule::~Rule() {
+}
+
+DevToolsNetworkRules::CompiledRule::CompiledRule() : resource_type_mask(0) {
+}
+
+DevToolsNetworkRules::CompiledRule::~CompiledRule() {
+  if (interceptor)
+    DevToolsNetworkInterceptor::DeleteWhenIdle(std::move(interceptor));
+}
+
+DevToolsNetworkRules::DevToolsNetworkRules() {
+}
+
+DevToolsNetworkRules::~DevToolsNetworkRules() {
+}
+
+void DevToolsNetworkRules::AddRule(std::unique_ptr<Rule> rule) {
+  size_t index = rules_.size();
+  std::unique_ptr<CompiledRule> compiled(new CompiledRule);
+
+  // "*.example.com" and ".example.com" also mean the subdomains.
+  std::string host = base::ToLowerASCII(rule->host);
+  if (base::StartsWith(host, "*.", base::CompareCase::SENSITIVE))
+    host.erase(0, 2);
+  else if (base::StartsWith(host, ".", base::CompareCase::SENSITIVE))
+    host.erase(0, 1);
+  rule->host = host;
+
+  if (!rule->url_pattern.empty()) {
+    compiled->segments = base::SplitString(
+        rule->url_pattern, "*", base::KEEP_WHITESPACE, base::SPLIT_WANT_ALL);
+  }
+  for (int type : rule->resource_types) {
+    DCHECK(type >= 0 && type < 64);
+    compiled->resource_type_mask |= uint64_t(1) << type;
+  }
+
+  // Index the rule by its most selective criterion.
+  if (!rule->host.empty()) {
+    host_index_[rule->host].push_back(index);
+  } else if (!compiled->segments.empty()) {
+    const std::string& prefix = compiled->segments.front();
+    prefix_index_[prefix].push_back(index);
+    prefix_lengths_.insert(prefix.size());
+  } else if (!rule->resource_types.empty()) {
+    for (int type : rule->resource_types)
+      resource_type_index_[type].push_back(index);
+  } else {
+    catch_all_rules_.push_back(index);
+  }
+
+  compiled->rule = std::move(rule);
+  rules_.push_back(std::move(compiled));
+}
+
+bool DevToolsNetworkRules::Match(const GURL& url,
+                                 int resource_type,
+                                 bool* blocked,
+                                 DevToolsNetworkInterceptor** interceptor) {
+  size_t best = kNoRule;
+
+  // The host and every domain it belongs to.
+  std::string host = url.host();
+  for (size_t pos = 0; pos != std::string::npos;) {
+    auto it = host_index_.find(host.substr(pos));
+    if (it != host_index_.end())
+      CheckCandidates(it->second, url, resource_type, &best);
+    pos = host.find('.', pos);
+    if (pos != std::string::npos)
+      ++pos;
+  }
+
+  const std::string& spec = url.possibly_invalid_spec();
+  for (size_t length : prefix_lengths_) {
+    if (length > spec.size())
+      break;
+    auto it = prefix_index_.find(spec.substr(0, length));
+    if (it != prefix_index_.end())
+      CheckCandidates(it->second, url, resource_type, &best);
+  }
+
+  auto it = resource_type_index_.find(resource_type);
+  if (it != resource_type_index_.end())
+    CheckCandidates(it->second, url, resource_type, &best);
+  CheckCandidates(catch_all_rules_, url, resource_type, &best);
+
+  if (best == kNoRule)
+    return false;
+
+  CompiledRule* compiled = rules_[best].get();
+  *blocked = compiled->rule->block;
+  *interceptor = nullptr;
+  if (*blocked)
+    return true;
+
+  if (!compiled->interceptor && compiled->rule->conditions) {
+    compiled->interceptor = DevToolsNetworkController::CreateInterceptor();
+    compiled->interceptor->UpdateConditions(
+        std::move(compiled->rule->conditions));
+  }
+  *interceptor = compiled->interceptor.get();
+  return true;
+}
+
+// static
+bool DevToolsNetworkRules::MatchSegments(
+    const std::string& spec, const std::vector<std::string>& segments) {
+  if (segments.size() == 1)
+    return spec == segments.front();
+
+  const std::string& first = segments.front();
+  const std::string& last = segments.back();
+  if (spec.size() < first.size() + last.size() ||
+      spec.compare(0, first.size(), first) != 0 ||
+      spec.compare(spec.size() - last.size(), last.size(), last) != 0) {
+    return false;
+  }
+
+  // Match the middle segments greedily from the left.
+  size_t pos = first.size();
+  size_t end = spec.size() - last.size();
+  for (size_t i = 1; i + 1 < segments.size(); ++i) {
+    const std::string& segment = segments[i];
+    if (segment.empty())
+      continue;
+    pos = spec.find(segment, pos);
+    if (pos == std::string::npos || pos + segment.size() > end)
+      return false;
+    pos += segment.size();
+  }
+  return true;
+}
+
+bool DevToolsNetworkRules::MatchRule(const CompiledRule& compiled,
+                                     const GURL& url,
+                                     int resource_type) const {
+  const Rule& rule = *compiled.rule;
+  if (!rule.host.empty() && !url.DomainIs(rule.host))
+    return false;
+  if (!compiled.segments.empty() &&
+      !MatchSegments(url.possibly_invalid_spec(), compiled.segments)) {
+    return false;
+  }
+  if (compiled.resource_type_mask) {
+    if (resource_type < 0 || resource_type >= 64 ||
+        !(compiled.resource_type_mask & (uint64_t(1) << resource_type))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DevToolsNetworkRules::CheckCandidates(
+    const std::vector<size_t>& candidates,
+    const GURL& url,
+    int resource_type,
+    size_t* best) const {
+  // Candidates are sorted, so the first match is the one added first.
+  for (size_t index : candidates) {
+    if (index >= *best)
+      return;
+    if (MatchRule(*rules_[index], url, resource_type)) {
+      *best = index;
+      return;
+    }
+  }
+}
+
+}  // namespace brightray
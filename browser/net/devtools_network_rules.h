@@ -0,0 +1,107 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_DEVTOOLS_NETWORK_RULES_H_
+#define BROWSER_DEVTOOLS_NETWORK_RULES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+
+class GURL;
+
+namespace brightray {
+
+class DevToolsNetworkConditions;
+class DevToolsNetworkInterceptor;
+
+// Throttling rules of a DevTools client. A request matching a rule is blocked
+// or throttled with the conditions of the rule instead of the ones of the
+// client. The first matching rule wins; rules are indexed by host, by the
+// literal prefix of their URL pattern and by resource type, so matching a
+// request only checks the rules that can possibly match it.
+class DevToolsNetworkRules {
+ public:
+  struct Rule {
+    Rule();
+    ~Rule();
+
+    // Matches the host and its subdomains, any host when empty.
+    std::string host;
+    // Matched against the whole URL, '*' matches any sequence of characters.
+    // Any URL when empty.
+    std::string url_pattern;
+    // Values of content::ResourceType, any type when empty.
+    std::vector<int> resource_types;
+    bool block;
+    // Conditions of the requests matching the rule, they are not throttled
+    // when null.
+    std::unique_ptr<DevToolsNetworkConditions> conditions;
+
+   private:
+    DISALLOW_COPY_AND_ASSIGN(Rule);
+  };
+
+  DevToolsNetworkRules();
+  // Must be destroyed on the IO thread.
+  ~DevToolsNetworkRules();
+
+  void AddRule(std::unique_ptr<Rule> rule);
+
+  // Called on the IO thread. Returns false when no rule matches the request,
+  // otherwise |blocked| tells whether the request must fail and |interceptor|
+  // is the one throttling it, or nullptr.
+  bool Match(const GURL& url,
+             int resource_type,
+             bool* blocked,
+             DevToolsNetworkInterceptor** interceptor);
+
+ private:
+  struct CompiledRule {
+    CompiledRule();
+    ~CompiledRule();
+
+    std::unique_ptr<Rule> rule;
+    // |url_pattern| split around the wildcards.
+    std::vector<std::string> segments;
+    uint64_t resource_type_mask;
+    // Created on the IO thread the first time the rule matches.
+    std::unique_ptr<DevToolsNetworkInterceptor> interceptor;
+  };
+
+  using RuleIndex = std::unordered_map<std::string, std::vector<size_t>>;
+
+  static bool MatchSegments(const std::string& spec,
+                            const std::vector<std::string>& segments);
+  bool MatchRule(const CompiledRule& compiled,
+                 const GURL& url,
+                 int resource_type) const;
+  void CheckCandidates(const std::vector<size_t>& candidates,
+                       const GURL& url,
+                       int resource_type,
+                       size_t* best) const;
+
+  std::vector<std::unique_ptr<CompiledRule>> rules_;
+
+  RuleIndex host_index_;
+  // Rules without host, by the literal prefix of their URL pattern.
+  RuleIndex prefix_index_;
+  std::set<size_t> prefix_lengths_;
+  // Rules with neither host nor URL pattern.
+  std::unordered_map<int, std::vector<size_t>> resource_type_index_;
+  std::vector<size_t> catch_all_rules_;
+
+  DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkRules);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_DEVTOOLS_NETWORK_RULES_H_
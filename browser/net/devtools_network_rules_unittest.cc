@@ -0,0 +1,118 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_rules.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace brightray {
+
+namespace {
+
+const int kImage = 2;
+const int kScript = 3;
+
+// The rules are left without conditions, creating their interceptors needs
+// the IO thread.
+class DevToolsNetworkRulesTest : public testing::Test {
+ protected:
+  void AddRule(const std::string& host,
+               const std::string& url_pattern,
+               const std::vector<int>& resource_types,
+               bool block) {
+    std::unique_ptr<DevToolsNetworkRules::Rule> rule(
+        new DevToolsNetworkRules::Rule);
+    rule->host = host;
+    rule->url_pattern = url_pattern;
+    rule->resource_types = resource_types;
+    rule->block = block;
+    rules_.AddRule(std::move(rule));
+  }
+
+  // Returns whether a rule matches, and sets |blocked_| to whether it blocks
+  // the request.
+  bool Match(const std::string& url, int resource_type = kImage) {
+    blocked_ = false;
+    DevToolsNetworkInterceptor* interceptor = nullptr;
+    bool matched =
+        rules_.Match(GURL(url), resource_type, &blocked_, &interceptor);
+    EXPECT_FALSE(interceptor);
+    return matched;
+  }
+
+  DevToolsNetworkRules rules_;
+  bool blocked_ = false;
+};
+
+}  // namespace
+
+TEST_F(DevToolsNetworkRulesTest, NoRules) {
+  EXPECT_FALSE(Match("https://example.com/"));
+}
+
+TEST_F(DevToolsNetworkRulesTest, Host) {
+  AddRule("*.Example.com", "", {}, true);
+
+  EXPECT_TRUE(Match("https://example.com/"));
+  EXPECT_TRUE(blocked_);
+  EXPECT_TRUE(Match("https://cdn.example.com/a.png"));
+  EXPECT_TRUE(blocked_);
+  EXPECT_FALSE(Match("https://notexample.com/"));
+  EXPECT_FALSE(Match("https://example.com.evil.net/"));
+}
+
+TEST_F(DevToolsNetworkRulesTest, FirstRuleWins) {
+  AddRule("api.example.com", "", {}, false);
+  AddRule(".example.com", "", {}, true);
+
+  EXPECT_TRUE(Match("https://api.example.com/x"));
+  EXPECT_FALSE(blocked_);
+  EXPECT_TRUE(Match("https://www.example.com/x"));
+  EXPECT_TRUE(blocked_);
+}
+
+TEST_F(DevToolsNetworkRulesTest, URLPattern) {
+  AddRule("", "https://ads.*/*.js", {}, true);
+  AddRule("", "*tracker*", {}, true);
+
+  EXPECT_TRUE(Match("https://ads.foo.com/a/b.js"));
+  EXPECT_TRUE(blocked_);
+  EXPECT_FALSE(Match("https://ads.foo.com/a/b.css"));
+  EXPECT_FALSE(Match("http://ads.foo.com/a/b.js"));
+  EXPECT_FALSE(Match("https://other.org/ads/b.js"));
+
+  EXPECT_TRUE(Match("https://other.org/tracker?x"));
+  EXPECT_TRUE(Match("https://tracker.other.org/"));
+  EXPECT_FALSE(Match("https://other.org/t.js"));
+}
+
+TEST_F(DevToolsNetworkRulesTest, LiteralPattern) {
+  AddRule("", "https://example.com/", {}, true);
+
+  // Without wildcards the pattern must match the whole URL.
+  EXPECT_TRUE(Match("https://example.com/"));
+  EXPECT_FALSE(Match("https://example.com/a"));
+}
+
+TEST_F(DevToolsNetworkRulesTest, ResourceTypes) {
+  AddRule("", "", {kScript}, false);
+  AddRule("", "*tracker*", {}, true);
+
+  EXPECT_TRUE(Match("https://other.org/t.js", kScript));
+  EXPECT_FALSE(blocked_);
+  EXPECT_FALSE(Match("https://other.org/t.js", kImage));
+
+  // The earlier rule wins for scripts only.
+  EXPECT_TRUE(Match("https://other.org/tracker", kScript));
+  EXPECT_FALSE(blocked_);
+  EXPECT_TRUE(Match("https://other.org/tracker", kImage));
+  EXPECT_TRUE(blocked_);
+}
+
+}  // namespace brightray
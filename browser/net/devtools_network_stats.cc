@@ -0,0 +1,89 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_stats.h"
+
+#include "net/base/net_errors.h"
+
+namespace brightray {
+
+namespace {
+
+const size_t kMaxTimelineEntries = 1000;
+
+}  // namespace
+
+DevToolsNetworkStats::Entry::Entry()
+    : transaction_id(0),
+      is_start(false),
+      is_upload(false),
+      bytes(0),
+      result(0) {
+}
+
+DevToolsNetworkStats::Counters::Counters()
+    : transactions(0),
+      chunks(0),
+      download_bytes(0),
+      upload_bytes(0),
+      failed(0),
+      cancelled(0),
+      unthrottled_websockets(0),
+      trace_load_failures(0) {
+}
+
+DevToolsNetworkStats::DevToolsNetworkStats() {
+}
+
+DevToolsNetworkStats::~DevToolsNetworkStats() {
+}
+
+void DevToolsNetworkStats::AddEntry(const Entry& entry, bool cancelled) {
+  base::AutoLock auto_lock(lock_);
+  if (entry.is_start)
+    ++counters_.transactions;
+  ++counters_.chunks;
+  if (entry.is_upload)
+    counters_.upload_bytes += entry.bytes;
+  else
+    counters_.download_bytes += entry.bytes;
+  if (cancelled)
+    ++counters_.cancelled;
+  else if (entry.result == net::ERR_INTERNET_DISCONNECTED)
+    ++counters_.failed;
+
+  if (!entry.released.is_null()) {
+    counters_.latency_time += entry.released - entry.queued;
+    counters_.bandwidth_time += entry.finished - entry.released;
+  } else {
+    counters_.latency_time += entry.finished - entry.queued;
+  }
+
+  if (timeline_.size() == kMaxTimelineEntries)
+    timeline_.pop_front();
+  timeline_.push_back(entry);
+}
+
+void DevToolsNetworkStats::AddUnthrottledWebSocket() {
+  base::AutoLock auto_lock(lock_);
+  ++counters_.unthrottled_websockets;
+}
+
+void DevToolsNetworkStats::AddTraceLoadFailure() {
+  base::AutoLock auto_lock(lock_);
+  ++counters_.trace_load_failures;
+}
+
+DevToolsNetworkStats::Counters DevToolsNetworkStats::GetCounters() const {
+  base::AutoLock auto_lock(lock_);
+  return counters_;
+}
+
+std::vector<DevToolsNetworkStats::Entry>
+DevToolsNetworkStats::GetTimeline() const {
+  base::AutoLock auto_lock(lock_);
+  return std::vector<Entry>(timeline_.begin(), timeline_.end());
+}
+
+}  // namespace brightray
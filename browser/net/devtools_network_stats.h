@@ -0,0 +1,90 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_DEVTOOLS_NETWORK_STATS_H_
+#define BROWSER_DEVTOOLS_NETWORK_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+
+namespace brightray {
+
+// Throttling statistics of a DevTools client, filled by the interceptors on
+// the IO thread and read by the protocol handler on the UI thread.
+class DevToolsNetworkStats
+    : public base::RefCountedThreadSafe<DevToolsNetworkStats> {
+ public:
+  // One chunk of a transaction that went through the interceptor.
+  struct Entry {
+    Entry();
+
+    uint64_t transaction_id;
+    bool is_start;
+    bool is_upload;
+    // Payload bytes of the chunk.
+    int64_t bytes;
+    int result;
+    // Passed to the interceptor.
+    base::TimeTicks queued;
+    // Done waiting for the latency, handshakes and retransmissions.
+    base::TimeTicks released;
+    // Bytes accounted and callback run, or cancelled.
+    base::TimeTicks finished;
+  };
+
+  struct Counters {
+    Counters();
+
+    int64_t transactions;
+    int64_t chunks;
+    int64_t download_bytes;
+    int64_t upload_bytes;
+    // Chunks failed by the offline mode.
+    int64_t failed;
+    // Chunks dropped by their transaction before finishing.
+    int64_t cancelled;
+    // WebSockets over HTTP/2, whose frames are not throttled.
+    int64_t unthrottled_websockets;
+    // Network.emulateNetworkConditions commands whose traces could not be
+    // loaded, their conditions were not applied.
+    int64_t trace_load_failures;
+    // Summed over all the chunks.
+    base::TimeDelta latency_time;
+    base::TimeDelta bandwidth_time;
+  };
+
+  DevToolsNetworkStats();
+
+  // Can be called on any thread.
+  void AddEntry(const Entry& entry, bool cancelled);
+  void AddUnthrottledWebSocket();
+  void AddTraceLoadFailure();
+  Counters GetCounters() const;
+  // Most recent entries last.
+  std::vector<Entry> GetTimeline() const;
+
+ private:
+  friend class base::RefCountedThreadSafe<DevToolsNetworkStats>;
+
+  ~DevToolsNetworkStats();
+
+  mutable base::Lock lock_;
+  Counters counters_;
+  // Only keeps the most recent entries.
+  std::deque<Entry> timeline_;
+
+  DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkStats);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_DEVTOOLS_NETWORK_STATS_H_
@@ -0,0 +1,211 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_stream_socket.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "net/base/net_errors.h"
+
+namespace brightray {
+
+DevToolsNetworkStreamSocket::DevToolsNetworkStreamSocket(
+    std::unique_ptr<net::StreamSocket> socket,
+    DevToolsNetworkInterceptor* interceptor,
+    uint64_t transaction_id,
+    const DevToolsNetworkInterceptor::Connection& connection)
+    : socket_(std::move(socket)),
+      interceptor_(interceptor->GetWeakPtr()),
+      transaction_id_(transaction_id),
+      connection_(connection),
+      read_started_(false),
+      read_throttle_callback_(
+          base::Bind(&DevToolsNetworkStreamSocket::ReadThrottled,
+                     base::Unretained(this))),
+      write_throttle_callback_(
+          base::Bind(&DevToolsNetworkStreamSocket::WriteThrottled,
+                     base::Unretained(this))),
+      read_throttle_handle_(DevToolsNetworkInterceptor::kInvalidThrottleHandle),
+      write_throttle_handle_(
+          DevToolsNetworkInterceptor::kInvalidThrottleHandle),
+      read_byte_count_(0),
+      write_byte_count_(0) {
+  connection_.streaming = true;
+}
+
+DevToolsNetworkStreamSocket::~DevToolsNetworkStreamSocket() {
+  if (interceptor_) {
+    interceptor_->StopThrottle(read_throttle_handle_);
+    interceptor_->StopThrottle(write_throttle_handle_);
+  }
+}
+
+int DevToolsNetworkStreamSocket::Read(net::IOBuffer* buf,
+                                      int buf_len,
+                                      const net::CompletionCallback& callback) {
+  DCHECK(read_callback_.is_null());
+  int result = socket_->Read(
+      buf, buf_len,
+      base::Bind(&DevToolsNetworkStreamSocket::OnReadCompleted,
+                 base::Unretained(this)));
+  // Data read right away was already waiting in the socket.
+  result = ThrottleRead(result, true);
+  if (result == net::ERR_IO_PENDING)
+    read_callback_ = callback;
+  return result;
+}
+
+int DevToolsNetworkStreamSocket::Write(
+    net::IOBuffer* buf,
+    int buf_len,
+    const net::CompletionCallback& callback) {
+  DCHECK(write_callback_.is_null());
+  int result = socket_->Write(
+      buf, buf_len,
+      base::Bind(&DevToolsNetworkStreamSocket::OnWriteCompleted,
+                 base::Unretained(this)));
+  result = ThrottleWrite(result);
+  if (result == net::ERR_IO_PENDING)
+    write_callback_ = callback;
+  return result;
+}
+
+void DevToolsNetworkStreamSocket::OnReadCompleted(int result) {
+  result = ThrottleRead(result, false);
+  if (result != net::ERR_IO_PENDING)
+    base::ResetAndReturn(&read_callback_).Run(result);
+}
+
+void DevToolsNetworkStreamSocket::OnWriteCompleted(int result) {
+  result = ThrottleWrite(result);
+  if (result != net::ERR_IO_PENDING)
+    base::ResetAndReturn(&write_callback_).Run(result);
+}
+
+int DevToolsNetworkStreamSocket::ThrottleRead(int result, bool buffered) {
+  // The end of the stream is not delayed.
+  if (!interceptor_ || result <= 0)
+    return result;
+
+  read_byte_count_ += result;
+  connection_.buffered = buffered;
+  int rv = interceptor_->StartThrottle(
+      result, read_byte_count_, base::TimeTicks::Now(), !read_started_,
+      false, transaction_id_, connection_, read_throttle_callback_,
+      &read_throttle_handle_);
+  read_started_ = true;
+  connection_.is_new = false;
+  return rv;
+}
+
+int DevToolsNetworkStreamSocket::ThrottleWrite(int result) {
+  if (!interceptor_ || result <= 0)
+    return result;
+
+  write_byte_count_ += result;
+  return interceptor_->StartThrottle(
+      result, write_byte_count_, base::TimeTicks(), false, true,
+      transaction_id_, DevToolsNetworkInterceptor::Connection(),
+      write_throttle_callback_, &write_throttle_handle_);
+}
+
+void DevToolsNetworkStreamSocket::ReadThrottled(int result, int64_t bytes) {
+  read_byte_count_ = bytes;
+  base::ResetAndReturn(&read_callback_).Run(result);
+}
+
+void DevToolsNetworkStreamSocket::WriteThrottled(int result, int64_t bytes) {
+  write_byte_count_ = bytes;
+  base::ResetAndReturn(&write_callback_).Run(result);
+}
+
+int DevToolsNetworkStreamSocket::SetReceiveBufferSize(int32_t size) {
+  return socket_->SetReceiveBufferSize(size);
+}
+
+int DevToolsNetworkStreamSocket::SetSendBufferSize(int32_t size) {
+  return socket_->SetSendBufferSize(size);
+}
+
+int DevToolsNetworkStreamSocket::Connect(
+    const net::CompletionCallback& callback) {
+  return socket_->Connect(callback);
+}
+
+void DevToolsNetworkStreamSocket::Disconnect() {
+  socket_->Disconnect();
+}
+
+bool DevToolsNetworkStreamSocket::IsConnected() const {
+  return socket_->IsConnected();
+}
+
+bool DevToolsNetworkStreamSocket::IsConnectedAndIdle() const {
+  return socket_->IsConnectedAndIdle();
+}
+
+int DevToolsNetworkStreamSocket::GetPeerAddress(
+    net::IPEndPoint* address) const {
+  return socket_->GetPeerAddress(address);
+}
+
+int DevToolsNetworkStreamSocket::GetLocalAddress(
+    net::IPEndPoint* address) const {
+  return socket_->GetLocalAddress(address);
+}
+
+const net::NetLogWithSource& DevToolsNetworkStreamSocket::NetLog() const {
+  return socket_->NetLog();
+}
+
+void DevToolsNetworkStreamSocket::SetSubresourceSpeculation() {
+  socket_->SetSubresourceSpeculation();
+}
+
+void DevToolsNetworkStreamSocket::SetOmniboxSpeculation() {
+  socket_->SetOmniboxSpeculation();
+}
+
+bool DevToolsNetworkStreamSocket::WasEverUsed() const {
+  return socket_->WasEverUsed();
+}
+
+bool DevToolsNetworkStreamSocket::WasAlpnNegotiated() const {
+  return socket_->WasAlpnNegotiated();
+}
+
+net::NextProto DevToolsNetworkStreamSocket::GetNegotiatedProtocol() const {
+  return socket_->GetNegotiatedProtocol();
+}
+
+bool DevToolsNetworkStreamSocket::GetSSLInfo(net::SSLInfo* ssl_info) {
+  return socket_->GetSSLInfo(ssl_info);
+}
+
+void DevToolsNetworkStreamSocket::GetConnectionAttempts(
+    net::ConnectionAttempts* out) const {
+  socket_->GetConnectionAttempts(out);
+}
+
+void DevToolsNetworkStreamSocket::ClearConnectionAttempts() {
+  socket_->ClearConnectionAttempts();
+}
+
+void DevToolsNetworkStreamSocket::AddConnectionAttempts(
+    const net::ConnectionAttempts& attempts) {
+  socket_->AddConnectionAttempts(attempts);
+}
+
+int64_t DevToolsNetworkStreamSocket::GetTotalReceivedBytes() const {
+  return socket_->GetTotalReceivedBytes();
+}
+
+void DevToolsNetworkStreamSocket::DumpMemoryStats(
+    net::SocketMemoryStats* stats) const {
+  socket_->DumpMemoryStats(stats);
+}
+
+}  // namespace brightray
@@ -0,0 +1,92 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_DEVTOOLS_NETWORK_STREAM_SOCKET_H_
+#define BROWSER_DEVTOOLS_NETWORK_STREAM_SOCKET_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "browser/net/devtools_network_interceptor.h"
+#include "net/base/completion_callback.h"
+#include "net/socket/stream_socket.h"
+
+namespace brightray {
+
+// Throttles the traffic of a socket that outlives its HTTP transaction, like
+// the one of a WebSocket. Reads pay the latency from the arrival of their
+// data, writes are only limited by the upload throughput.
+class DevToolsNetworkStreamSocket : public net::StreamSocket {
+ public:
+  DevToolsNetworkStreamSocket(
+      std::unique_ptr<net::StreamSocket> socket,
+      DevToolsNetworkInterceptor* interceptor,
+      uint64_t transaction_id,
+      const DevToolsNetworkInterceptor::Connection& connection);
+  ~DevToolsNetworkStreamSocket() override;
+
+  // net::Socket:
+  int Read(net::IOBuffer* buf,
+           int buf_len,
+           const net::CompletionCallback& callback) override;
+  int Write(net::IOBuffer* buf,
+            int buf_len,
+            const net::CompletionCallback& callback) override;
+  int SetReceiveBufferSize(int32_t size) override;
+  int SetSendBufferSize(int32_t size) override;
+
+  // net::StreamSocket:
+  int Connect(const net::CompletionCallback& callback) override;
+  void Disconnect() override;
+  bool IsConnected() const override;
+  bool IsConnectedAndIdle() const override;
+  int GetPeerAddress(net::IPEndPoint* address) const override;
+  int GetLocalAddress(net::IPEndPoint* address) const override;
+  const net::NetLogWithSource& NetLog() const override;
+  void SetSubresourceSpeculation() override;
+  void SetOmniboxSpeculation() override;
+  bool WasEverUsed() const override;
+  bool WasAlpnNegotiated() const override;
+  net::NextProto GetNegotiatedProtocol() const override;
+  bool GetSSLInfo(net::SSLInfo* ssl_info) override;
+  void GetConnectionAttempts(net::ConnectionAttempts* out) const override;
+  void ClearConnectionAttempts() override;
+  void AddConnectionAttempts(const net::ConnectionAttempts& attempts) override;
+  int64_t GetTotalReceivedBytes() const override;
+  void DumpMemoryStats(net::SocketMemoryStats* stats) const override;
+
+ private:
+  void OnReadCompleted(int result);
+  void OnWriteCompleted(int result);
+
+  int ThrottleRead(int result, bool buffered);
+  int ThrottleWrite(int result);
+  void ReadThrottled(int result, int64_t bytes);
+  void WriteThrottled(int result, int64_t bytes);
+
+  std::unique_ptr<net::StreamSocket> socket_;
+  base::WeakPtr<DevToolsNetworkInterceptor> interceptor_;
+  const uint64_t transaction_id_;
+  // Only the first read pays for the handshakes of a new socket.
+  DevToolsNetworkInterceptor::Connection connection_;
+  bool read_started_;
+
+  net::CompletionCallback read_callback_;
+  net::CompletionCallback write_callback_;
+  DevToolsNetworkInterceptor::ThrottleCallback read_throttle_callback_;
+  DevToolsNetworkInterceptor::ThrottleCallback write_throttle_callback_;
+  DevToolsNetworkInterceptor::ThrottleHandle read_throttle_handle_;
+  DevToolsNetworkInterceptor::ThrottleHandle write_throttle_handle_;
+  int64_t read_byte_count_;
+  int64_t write_byte_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkStreamSocket);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_DEVTOOLS_NETWORK_STREAM_SOCKET_H_
@@ -0,0 +1,96 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_trace.h"
+
+#include <algorithm>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+
+namespace brightray {
+
+namespace {
+
+// Recorded cellular traces are a few megabytes at most.
+const size_t kMaxTraceSize = 64 * 1024 * 1024;
+
+}  // namespace
+
+// static
+scoped_refptr<DevToolsNetworkTrace> DevToolsNetworkTrace::Parse(
+    const std::string& data) {
+  std::vector<base::TimeDelta> timestamps;
+  for (const base::StringPiece& line : base::SplitStringPiece(
+           data, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    int64_t ms = 0;
+    if (!base::StringToInt64(line, &ms) || ms < 0)
+      return nullptr;
+    base::TimeDelta timestamp = base::TimeDelta::FromMilliseconds(ms);
+    if (!timestamps.empty() && timestamp < timestamps.back())
+      return nullptr;
+    timestamps.push_back(timestamp);
+  }
+
+  // A trace that ends at 0ms would deliver infinitely fast when looped.
+  if (timestamps.empty() || timestamps.back().is_zero())
+    return nullptr;
+
+  return make_scoped_refptr(new DevToolsNetworkTrace(std::move(timestamps)));
+}
+
+// static
+scoped_refptr<DevToolsNetworkTrace> DevToolsNetworkTrace::LoadFromFile(
+    const base::FilePath& path) {
+  std::string data;
+  if (!base::ReadFileToStringWithMaxSize(path, &data, kMaxTraceSize))
+    return nullptr;
+  return Parse(data);
+}
+
+DevToolsNetworkTrace::DevToolsNetworkTrace(
+    std::vector<base::TimeDelta> timestamps)
+    : timestamps_(std::move(timestamps)),
+      duration_(timestamps_.back()) {
+}
+
+DevToolsNetworkTrace::~DevToolsNetworkTrace() {
+}
+
+int64_t DevToolsNetworkTrace::GetDeliveryCount(base::TimeDelta elapsed,
+                                               bool loop) const {
+  if (elapsed < base::TimeDelta())
+    return 0;
+
+  int64_t periods = 0;
+  if (loop) {
+    periods = elapsed / duration_;
+    elapsed -= duration_ * periods;
+  } else if (elapsed > duration_) {
+    elapsed = duration_;
+  }
+
+  int64_t in_period =
+      std::upper_bound(timestamps_.begin(), timestamps_.end(), elapsed) -
+      timestamps_.begin();
+  return periods * size() + in_period;
+}
+
+base::TimeDelta DevToolsNetworkTrace::GetDeliveryTime(int64_t count,
+                                                      bool loop) const {
+  if (count <= 0)
+    return base::TimeDelta();
+
+  int64_t index = count - 1;
+  if (!loop) {
+    DCHECK_LT(index, size());
+    return timestamps_[std::min(index, size() - 1)];
+  }
+  return duration_ * (index / size()) + timestamps_[index % size()];
+}
+
+}  // namespace brightray
@@ -0,0 +1,62 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_DEVTOOLS_NETWORK_TRACE_H_
+#define BROWSER_DEVTOOLS_NETWORK_TRACE_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/time/time.h"
+
+namespace base {
+class FilePath;
+}
+
+namespace brightray {
+
+// A recorded link in the Mahimahi format: every line of the trace holds the
+// time in milliseconds at which one MTU sized packet can be delivered, and
+// the trace repeats itself once the last timestamp has passed.
+class DevToolsNetworkTrace
+    : public base::RefCountedThreadSafe<DevToolsNetworkTrace> {
+ public:
+  // Returns nullptr when |data| is not a valid trace.
+  static scoped_refptr<DevToolsNetworkTrace> Parse(const std::string& data);
+
+  // Must be called on a thread that allows IO.
+  static scoped_refptr<DevToolsNetworkTrace> LoadFromFile(
+      const base::FilePath& path);
+
+  // Number of delivery opportunities that happened during the first |elapsed|
+  // of the replay.
+  int64_t GetDeliveryCount(base::TimeDelta elapsed, bool loop) const;
+
+  // Time since the start of the replay at which the |count|-th delivery
+  // opportunity happens. For one-shot replays |count| must not exceed size().
+  base::TimeDelta GetDeliveryTime(int64_t count, bool loop) const;
+
+  int64_t size() const { return timestamps_.size(); }
+  base::TimeDelta duration() const { return duration_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<DevToolsNetworkTrace>;
+
+  explicit DevToolsNetworkTrace(std::vector<base::TimeDelta> timestamps);
+  ~DevToolsNetworkTrace();
+
+  // Sorted delivery opportunities of one period.
+  const std::vector<base::TimeDelta> timestamps_;
+  const base::TimeDelta duration_;
+
+  DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkTrace);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_DEVTOOLS_NETWORK_TRACE_H_
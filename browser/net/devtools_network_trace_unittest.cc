@@ -0,0 +1,56 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_trace.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brightray {
+
+TEST(DevToolsNetworkTraceTest, Parse) {
+  scoped_refptr<DevToolsNetworkTrace> trace =
+      DevToolsNetworkTrace::Parse("0\n10\n 20 \n\n");
+  ASSERT_TRUE(trace);
+  EXPECT_EQ(3, trace->size());
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(20), trace->duration());
+}
+
+TEST(DevToolsNetworkTraceTest, ParseRejectsInvalidTraces) {
+  EXPECT_FALSE(DevToolsNetworkTrace::Parse(""));
+  EXPECT_FALSE(DevToolsNetworkTrace::Parse("0\n0\n"));
+  EXPECT_FALSE(DevToolsNetworkTrace::Parse("10\n5\n"));
+  EXPECT_FALSE(DevToolsNetworkTrace::Parse("-5\n10\n"));
+  EXPECT_FALSE(DevToolsNetworkTrace::Parse("5\nten\n"));
+}
+
+TEST(DevToolsNetworkTraceTest, DeliveryCount) {
+  scoped_refptr<DevToolsNetworkTrace> trace =
+      DevToolsNetworkTrace::Parse("0\n10\n20\n");
+  ASSERT_TRUE(trace);
+
+  EXPECT_EQ(0, trace->GetDeliveryCount(
+      base::TimeDelta::FromMilliseconds(-1), false));
+  EXPECT_EQ(2, trace->GetDeliveryCount(
+      base::TimeDelta::FromMilliseconds(15), false));
+  EXPECT_EQ(3, trace->GetDeliveryCount(
+      base::TimeDelta::FromMilliseconds(25), false));
+  EXPECT_EQ(4, trace->GetDeliveryCount(
+      base::TimeDelta::FromMilliseconds(25), true));
+}
+
+TEST(DevToolsNetworkTraceTest, DeliveryTime) {
+  scoped_refptr<DevToolsNetworkTrace> trace =
+      DevToolsNetworkTrace::Parse("0\n10\n20\n");
+  ASSERT_TRUE(trace);
+
+  EXPECT_EQ(base::TimeDelta(), trace->GetDeliveryTime(0, false));
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(10),
+            trace->GetDeliveryTime(2, false));
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(20),
+            trace->GetDeliveryTime(4, true));
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(40),
+            trace->GetDeliveryTime(6, true));
+}
+
+}  // namespace brightray
@@ -4,26 +4,56 @@
 
 #include "browser/net/devtools_network_transaction.h"
 
+#include "base/strings/string_number_conversions.h"
 #include "browser/net/devtools_network_controller.h"
 #include "browser/net/devtools_network_upload_data_stream.h"
+#include "browser/net/devtools_network_websocket_create_helper.h"
 #include "net/base/load_timing_info.h"
 #include "net/base/net_errors.h"
 #include "net/base/upload_progress.h"
 #include "net/http/http_network_transaction.h"
 #include "net/http/http_request_info.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_response_info.h"
 #include "net/socket/connection_attempts.h"
 
 namespace brightray {
 
+namespace {
+
+// Only used on the IO thread.
+uint64_t g_next_transaction_id = 0;
+
+DevToolsNetworkInterceptor::Connection GetConnection(
+    const net::LoadTimingInfo& load_timing_info) {
+  DevToolsNetworkInterceptor::Connection connection;
+  connection.socket_id = load_timing_info.socket_log_id;
+  connection.is_new = !load_timing_info.socket_reused;
+  connection.resolved_host =
+      !load_timing_info.connect_timing.dns_start.is_null();
+  connection.secure = !load_timing_info.connect_timing.ssl_start.is_null();
+  return connection;
+}
+
+}  // namespace
+
 // static
 const char
     DevToolsNetworkTransaction::kDevToolsEmulateNetworkConditionsClientId[] =
         "X-DevTools-Emulate-Network-Conditions-Client-Id";
 
+// static
+const char DevToolsNetworkTransaction::kDevToolsResourceType[] =
+    "X-DevTools-Resource-Type";
+
 DevToolsNetworkTransaction::DevToolsNetworkTransaction(
     DevToolsNetworkController* controller,
     std::unique_ptr<net::HttpTransaction> transaction)
-    : throttled_byte_count_(0),
+    : throttle_handle_(DevToolsNetworkInterceptor::kInvalidThrottleHandle),
+      throttled_byte_count_(0),
+      socket_id_(0),
+      event_stream_(false),
+      id_(++g_next_transaction_id),
       controller_(controller),
       transaction_(std::move(transaction)),
       request_(nullptr),
@@ -33,32 +63,62 @@ DevToolsNetworkTransaction::DevToolsNetworkTransaction(
 
 DevToolsNetworkTransaction::~DevToolsNetworkTransaction() {
   if (interceptor_ && !throttle_callback_.is_null())
-    interceptor_->StopThrottle(throttle_callback_);
+    interceptor_->StopThrottle(throttle_handle_);
 }
 
 void DevToolsNetworkTransaction::IOCallback(
     const net::CompletionCallback& callback, bool start, int result) {
-  result = Throttle(callback, start, result);
+  result = Throttle(callback, start, false, result);
   if (result != net::ERR_IO_PENDING)
     callback.Run(result);
 }
 
 int DevToolsNetworkTransaction::Throttle(
-    const net::CompletionCallback& callback, bool start, int result) {
+    const net::CompletionCallback& callback,
+    bool start,
+    bool buffered,
+    int result) {
   if (failed_)
     return net::ERR_INTERNET_DISCONNECTED;
-  if (!interceptor_ || result < 0)
+  // WebSockets are throttled by their socket, handshake included, unless
+  // they go over HTTP/2.
+  if (!interceptor_ || result < 0 ||
+      (websocket_create_helper_ &&
+       websocket_create_helper_->socket_throttled())) {
     return result;
+  }
 
   base::TimeTicks send_end;
+  DevToolsNetworkInterceptor::Connection connection;
   if (start) {
     throttled_byte_count_ += transaction_->GetTotalReceivedBytes();
     net::LoadTimingInfo load_timing_info;
-    if (GetLoadTimingInfo(&load_timing_info))
+    if (GetLoadTimingInfo(&load_timing_info)) {
       send_end = load_timing_info.send_end;
+      connection = GetConnection(load_timing_info);
+      socket_id_ = connection.socket_id;
+      // A request body opening the connection already paid its setup.
+      if (custom_upload_data_stream_ &&
+          custom_upload_data_stream_->connection_charged()) {
+        connection.is_new = false;
+      }
+    }
     if (send_end.is_null())
       send_end = base::TimeTicks::Now();
+
+    // Each event of a server-sent event stream pays the latency.
+    const net::HttpResponseInfo* response_info =
+        transaction_->GetResponseInfo();
+    std::string mime_type;
+    event_stream_ = response_info && response_info->headers &&
+                    response_info->headers->GetMimeType(&mime_type) &&
+                    mime_type == "text/event-stream";
+  } else if (event_stream_) {
+    send_end = base::TimeTicks::Now();
   }
+  connection.socket_id = socket_id_;
+  connection.streaming = event_stream_;
+  connection.buffered = buffered;
   if (result > 0)
     throttled_byte_count_ += result;
 
@@ -66,7 +126,9 @@ int DevToolsNetworkTransaction::Throttle(
                                   base::Unretained(this),
                                   callback);
   int rv = interceptor_->StartThrottle(result, throttled_byte_count_, send_end,
-                                       start, false, throttle_callback_);
+                                       start, false, id_, connection,
+                                       throttle_callback_,
+                                       &throttle_handle_);
   if (rv != net::ERR_IO_PENDING)
     throttle_callback_.Reset();
   if (rv == net::ERR_INTERNET_DISCONNECTED)
@@ -84,6 +146,20 @@ void DevToolsNetworkTransaction::ThrottleCallback(
   callback.Run(result);
 }
 
+void DevToolsNetworkTransaction::BeforeHeadersSent(
+    const net::ProxyInfo& proxy_info,
+    net::HttpRequestHeaders* headers) {
+  headers->RemoveHeader(kDevToolsEmulateNetworkConditionsClientId);
+  headers->RemoveHeader(kDevToolsResourceType);
+  // The stream is connected once the headers are built, before the body is
+  // read.
+  net::LoadTimingInfo load_timing_info;
+  if (custom_upload_data_stream_ && GetLoadTimingInfo(&load_timing_info))
+    custom_upload_data_stream_->SetConnection(GetConnection(load_timing_info));
+  if (!before_headers_sent_callback_.is_null())
+    before_headers_sent_callback_.Run(proxy_info, headers);
+}
+
 void DevToolsNetworkTransaction::Fail() {
   DCHECK(request_);
   DCHECK(!failed_);
@@ -110,30 +186,42 @@ int DevToolsNetworkTransaction::Start(const net::HttpRequestInfo* request,
   request_ = request;
 
   std::string client_id;
-  bool has_devtools_client_id = request_->extra_headers.HasHeader(
-      kDevToolsEmulateNetworkConditionsClientId);
-  if (has_devtools_client_id) {
-    custom_request_.reset(new net::HttpRequestInfo(*request_));
-    custom_request_->extra_headers.GetHeader(
-        kDevToolsEmulateNetworkConditionsClientId, &client_id);
-    custom_request_->extra_headers.RemoveHeader(
-        kDevToolsEmulateNetworkConditionsClientId);
-
-    if (request_->upload_data_stream) {
-      custom_upload_data_stream_.reset(
-          new DevToolsNetworkUploadDataStream(request_->upload_data_stream));
-      custom_request_->upload_data_stream = custom_upload_data_stream_.get();
+  int resource_type = -1;
+  if (request_->extra_headers.GetHeader(
+          kDevToolsEmulateNetworkConditionsClientId, &client_id)) {
+    std::string resource_type_value;
+    if (request_->extra_headers.GetHeader(kDevToolsResourceType,
+                                          &resource_type_value)) {
+      base::StringToInt(resource_type_value, &resource_type);
     }
 
-    request_ = custom_request_.get();
+    // Strip our headers from the ones the network transaction builds rather
+    // than copying the whole request.
+    transaction_->SetBeforeHeadersSentCallback(
+        base::Bind(&DevToolsNetworkTransaction::BeforeHeadersSent,
+                   base::Unretained(this)));
   }
 
-  DevToolsNetworkInterceptor* interceptor =
-      controller_->GetInterceptor(client_id);
+  bool blocked = false;
+  DevToolsNetworkInterceptor* interceptor = controller_->GetInterceptor(
+      client_id, request_->url, resource_type, &blocked);
+  if (blocked)
+    return net::ERR_BLOCKED_BY_CLIENT;
   if (interceptor) {
     interceptor_ = interceptor->GetWeakPtr();
-    if (custom_upload_data_stream_)
-      custom_upload_data_stream_->SetInterceptor(interceptor);
+
+    // Wrapping the upload means copying the request, only do it when the
+    // upload is actually throttled.
+    if (request_->upload_data_stream && interceptor->ShouldThrottleUpload()) {
+      custom_request_.reset(new net::HttpRequestInfo(*request_));
+      custom_upload_data_stream_.reset(
+          new DevToolsNetworkUploadDataStream(request_->upload_data_stream));
+      custom_upload_data_stream_->SetInterceptor(interceptor, id_);
+      custom_request_->upload_data_stream = custom_upload_data_stream_.get();
+      request_ = custom_request_.get();
+    }
+    if (websocket_create_helper_)
+      websocket_create_helper_->SetInterceptor(interceptor, id_);
   }
 
   if (CheckFailed())
@@ -146,7 +234,7 @@ int DevToolsNetworkTransaction::Start(const net::HttpRequestInfo* request,
       base::Bind(&DevToolsNetworkTransaction::IOCallback,
                  base::Unretained(this), callback, true),
       net_log);
-  return Throttle(callback, true, result);
+  return Throttle(callback, true, false, result);
 }
 
 int DevToolsNetworkTransaction::RestartIgnoringLastError(
@@ -159,7 +247,7 @@ int DevToolsNetworkTransaction::RestartIgnoringLastError(
   int result = transaction_->RestartIgnoringLastError(
       base::Bind(&DevToolsNetworkTransaction::IOCallback,
                  base::Unretained(this), callback, true));
-  return Throttle(callback, true, result);
+  return Throttle(callback, true, false, result);
 }
 
 int DevToolsNetworkTransaction::RestartWithCertificate(
@@ -177,7 +265,7 @@ int DevToolsNetworkTransaction::RestartWithCertificate(
       client_cert, client_private_key,
       base::Bind(&DevToolsNetworkTransaction::IOCallback,
                  base::Unretained(this), callback, true));
-  return Throttle(callback, true, result);
+  return Throttle(callback, true, false, result);
 }
 
 int DevToolsNetworkTransaction::RestartWithAuth(
@@ -191,7 +279,7 @@ int DevToolsNetworkTransaction::RestartWithAuth(
   int result = transaction_->RestartWithAuth(credentials,
       base::Bind(&DevToolsNetworkTransaction::IOCallback,
                  base::Unretained(this), callback, true));
-  return Throttle(callback, true, result);
+  return Throttle(callback, true, false, result);
 }
 
 bool DevToolsNetworkTransaction::IsReadyToRestartForAuth() {
@@ -213,7 +301,8 @@ int DevToolsNetworkTransaction::Read(
   // URLRequestJob relies on synchronous end-of-stream notification.
   if (result == 0)
     return result;
-  return Throttle(callback, false, result);
+  // Data read right away was already waiting in the stream.
+  return Throttle(callback, false, true, result);
 }
 
 void DevToolsNetworkTransaction::StopCaching() {
@@ -272,7 +361,10 @@ void DevToolsNetworkTransaction::SetPriority(net::RequestPriority priority) {
 
 void DevToolsNetworkTransaction::SetWebSocketHandshakeStreamCreateHelper(
     net::WebSocketHandshakeStreamBase::CreateHelper* helper) {
-  transaction_->SetWebSocketHandshakeStreamCreateHelper(helper);
+  websocket_create_helper_.reset(
+      new DevToolsNetworkWebSocketCreateHelper(helper));
+  transaction_->SetWebSocketHandshakeStreamCreateHelper(
+      websocket_create_helper_.get());
 }
 
 void DevToolsNetworkTransaction::SetBeforeNetworkStartCallback(
@@ -282,6 +374,7 @@ void DevToolsNetworkTransaction::SetBeforeNetworkStartCallback(
 
 void DevToolsNetworkTransaction::SetBeforeHeadersSentCallback(
     const BeforeHeadersSentCallback& callback) {
+  before_headers_sent_callback_ = callback;
   transaction_->SetBeforeHeadersSentCallback(callback);
 }
 
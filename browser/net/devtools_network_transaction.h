@@ -19,10 +19,14 @@ namespace brightray {
 
 class DevToolsNetworkController;
 class DevToolsNetworkUploadDataStream;
+class DevToolsNetworkWebSocketCreateHelper;
 
 class DevToolsNetworkTransaction : public net::HttpTransaction {
  public:
   static const char kDevToolsEmulateNetworkConditionsClientId[];
+  // Set by the NetworkDelegate on requests of DevTools clients, holds their
+  // content::ResourceType.
+  static const char kDevToolsResourceType[];
 
   DevToolsNetworkTransaction(
       DevToolsNetworkController* controller,
@@ -73,25 +77,44 @@ class DevToolsNetworkTransaction : public net::HttpTransaction {
   void IOCallback(const net::CompletionCallback& callback,
                   bool start,
                   int result);
+  // |buffered| is set when |result| was returned right away by a read.
   int Throttle(const net::CompletionCallback& callback,
                bool start,
+               bool buffered,
                int result);
   void ThrottleCallback(const net::CompletionCallback& callback,
                         int result,
                         int64_t bytes);
+  void BeforeHeadersSent(const net::ProxyInfo& proxy_info,
+                         net::HttpRequestHeaders* headers);
 
   DevToolsNetworkInterceptor::ThrottleCallback throttle_callback_;
+  DevToolsNetworkInterceptor::ThrottleHandle throttle_handle_;
   int64_t throttled_byte_count_;
+  // NetLog id of the socket of the response, for the connection model.
+  uint32_t socket_id_;
+  bool event_stream_;
+  // Identifies the transaction in the throttling statistics.
+  const uint64_t id_;
 
   DevToolsNetworkController* controller_;
   base::WeakPtr<DevToolsNetworkInterceptor> interceptor_;
 
-  // Modified upload data stream. Should be destructed after |custom_request_|.
+  BeforeHeadersSentCallback before_headers_sent_callback_;
+
+  // Throttled upload data stream. Should be destructed after
+  // |custom_request_|.
   std::unique_ptr<DevToolsNetworkUploadDataStream> custom_upload_data_stream_;
 
-  // Modified request. Should be destructed after |transaction_|.
+  // Copy of the request using |custom_upload_data_stream_|. Should be
+  // destructed after |transaction_|.
   std::unique_ptr<net::HttpRequestInfo> custom_request_;
 
+  // Wraps the socket of WebSocket handshakes. Should be destructed after
+  // |transaction_|.
+  std::unique_ptr<DevToolsNetworkWebSocketCreateHelper>
+      websocket_create_helper_;
+
   // Original network transaction.
   std::unique_ptr<net::HttpTransaction> transaction_;
 
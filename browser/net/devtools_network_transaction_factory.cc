@@ -22,6 +22,7 @@ DevToolsNetworkTransactionFactory::DevToolsNetworkTransactionFactory(
   std::set<std::string> headers;
   headers.insert(
       DevToolsNetworkTransaction::kDevToolsEmulateNetworkConditionsClientId);
+  headers.insert(DevToolsNetworkTransaction::kDevToolsResourceType);
   content::ServiceWorkerContext::AddExcludedHeadersForFetchEvent(headers);
 }
 
@@ -15,20 +15,30 @@ DevToolsNetworkUploadDataStream::DevToolsNetworkUploadDataStream(
       throttle_callback_(
           base::Bind(&DevToolsNetworkUploadDataStream::ThrottleCallback,
                      base::Unretained(this))),
+      throttle_handle_(DevToolsNetworkInterceptor::kInvalidThrottleHandle),
       throttled_byte_count_(0),
+      transaction_id_(0),
+      read_started_(false),
+      connection_charged_(false),
       upload_data_stream_(upload_data_stream) {
 }
 
 DevToolsNetworkUploadDataStream::~DevToolsNetworkUploadDataStream() {
   if (interceptor_)
-    interceptor_->StopThrottle(throttle_callback_);
+    interceptor_->StopThrottle(throttle_handle_);
 }
 
 void DevToolsNetworkUploadDataStream::SetInterceptor(
-    DevToolsNetworkInterceptor* interceptor) {
+    DevToolsNetworkInterceptor* interceptor, uint64_t transaction_id) {
   DCHECK(!interceptor_);
   if (interceptor)
     interceptor_ = interceptor->GetWeakPtr();
+  transaction_id_ = transaction_id;
+}
+
+void DevToolsNetworkUploadDataStream::SetConnection(
+    const DevToolsNetworkInterceptor::Connection& connection) {
+  connection_ = connection;
 }
 
 bool DevToolsNetworkUploadDataStream::IsInMemory() const {
@@ -38,6 +48,8 @@ bool DevToolsNetworkUploadDataStream::IsInMemory() const {
 int DevToolsNetworkUploadDataStream::InitInternal(
     const net::NetLogWithSource& net_log) {
   throttled_byte_count_ = 0;
+  read_started_ = false;
+  connection_charged_ = false;
   int result = upload_data_stream_->Init(
       base::Bind(&DevToolsNetworkUploadDataStream::StreamInitCallback,
                  base::Unretained(this)),
@@ -76,8 +88,17 @@ int DevToolsNetworkUploadDataStream::ThrottleRead(int result) {
 
   if (result > 0)
     throttled_byte_count_ += result;
+  bool start = !read_started_;
+  read_started_ = true;
+  base::TimeTicks send_end = start ? base::TimeTicks::Now() : base::TimeTicks();
+  DevToolsNetworkInterceptor::Connection connection;
+  if (start) {
+    connection = connection_;
+    connection_charged_ = connection.is_new;
+  }
   return interceptor_->StartThrottle(result, throttled_byte_count_,
-      base::TimeTicks(), false, true, throttle_callback_);
+      send_end, start, true, transaction_id_, connection, throttle_callback_,
+      &throttle_handle_);
 }
 
 void DevToolsNetworkUploadDataStream::ThrottleCallback(
@@ -89,8 +110,10 @@ void DevToolsNetworkUploadDataStream::ThrottleCallback(
 void DevToolsNetworkUploadDataStream::ResetInternal() {
   upload_data_stream_->Reset();
   throttled_byte_count_ = 0;
+  read_started_ = false;
+  connection_charged_ = false;
   if (interceptor_)
-    interceptor_->StopThrottle(throttle_callback_);
+    interceptor_->StopThrottle(throttle_handle_);
 }
 
 }  // namespace brightray
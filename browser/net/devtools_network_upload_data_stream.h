@@ -22,7 +22,15 @@ class DevToolsNetworkUploadDataStream : public net::UploadDataStream {
       net::UploadDataStream* upload_data_stream);
   ~DevToolsNetworkUploadDataStream() override;
 
-  void SetInterceptor(DevToolsNetworkInterceptor* interceptor);
+  void SetInterceptor(DevToolsNetworkInterceptor* interceptor,
+                      uint64_t transaction_id);
+
+  // Set once the socket of the request is known, the first chunk of the body
+  // pays the setup of a new connection.
+  void SetConnection(const DevToolsNetworkInterceptor::Connection& connection);
+  // Whether the body already paid the setup of the connection, the response
+  // must not pay it again.
+  bool connection_charged() const { return connection_charged_; }
 
  private:
   // net::UploadDataStream implementation.
@@ -38,7 +46,13 @@ class DevToolsNetworkUploadDataStream : public net::UploadDataStream {
   void ThrottleCallback(int result, int64_t bytes);
 
   DevToolsNetworkInterceptor::ThrottleCallback throttle_callback_;
+  DevToolsNetworkInterceptor::ThrottleHandle throttle_handle_;
   int64_t throttled_byte_count_;
+  uint64_t transaction_id_;
+  // The first chunk of the body waits for the uplink latency.
+  bool read_started_;
+  DevToolsNetworkInterceptor::Connection connection_;
+  bool connection_charged_;
 
   net::UploadDataStream* upload_data_stream_;
   base::WeakPtr<DevToolsNetworkInterceptor> interceptor_;
@@ -0,0 +1,112 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_virtual_time.h"
+
+#include <algorithm>
+
+#include "base/bind.h"
+
+namespace brightray {
+
+DevToolsNetworkVirtualTime::Clock::Clock(DevToolsNetworkVirtualTime* owner)
+    : owner_(owner) {
+}
+
+DevToolsNetworkVirtualTime::Clock::~Clock() {
+}
+
+base::TimeTicks DevToolsNetworkVirtualTime::Clock::NowTicks() {
+  return owner_->Now();
+}
+
+DevToolsNetworkVirtualTime::PendingTask::PendingTask() : sequence(0) {
+}
+
+DevToolsNetworkVirtualTime::PendingTask::PendingTask(
+    const PendingTask& other) = default;
+
+DevToolsNetworkVirtualTime::PendingTask::~PendingTask() {
+}
+
+bool DevToolsNetworkVirtualTime::PendingTask::operator>(
+    const PendingTask& other) const {
+  if (run_time != other.run_time)
+    return run_time > other.run_time;
+  return sequence > other.sequence;
+}
+
+DevToolsNetworkVirtualTime::DevToolsNetworkVirtualTime(
+    scoped_refptr<base::SingleThreadTaskRunner> task_runner)
+    : task_runner_(task_runner),
+      clock_(this),
+      now_(base::TimeTicks::Now()),
+      next_sequence_(0),
+      run_scheduled_(false) {
+}
+
+DevToolsNetworkVirtualTime::~DevToolsNetworkVirtualTime() {
+}
+
+bool DevToolsNetworkVirtualTime::PostDelayedTask(
+    const tracked_objects::Location& from_here,
+    const base::Closure& task,
+    base::TimeDelta delay) {
+  base::AutoLock auto_lock(lock_);
+  PendingTask pending_task;
+  pending_task.run_time = now_ + std::max(delay, base::TimeDelta());
+  pending_task.sequence = next_sequence_++;
+  pending_task.task = task;
+  tasks_.push(pending_task);
+  ScheduleRunLocked();
+  return true;
+}
+
+bool DevToolsNetworkVirtualTime::PostNonNestableDelayedTask(
+    const tracked_objects::Location& from_here,
+    const base::Closure& task,
+    base::TimeDelta delay) {
+  return PostDelayedTask(from_here, task, delay);
+}
+
+bool DevToolsNetworkVirtualTime::RunsTasksOnCurrentThread() const {
+  return task_runner_->RunsTasksOnCurrentThread();
+}
+
+base::TimeTicks DevToolsNetworkVirtualTime::Now() {
+  base::AutoLock auto_lock(lock_);
+  return now_;
+}
+
+void DevToolsNetworkVirtualTime::ScheduleRunLocked() {
+  lock_.AssertAcquired();
+  if (run_scheduled_ || tasks_.empty())
+    return;
+  run_scheduled_ = true;
+  task_runner_->PostTask(
+      FROM_HERE, base::Bind(&DevToolsNetworkVirtualTime::RunNextTask, this));
+}
+
+void DevToolsNetworkVirtualTime::RunNextTask() {
+  base::Closure task;
+  {
+    base::AutoLock auto_lock(lock_);
+    run_scheduled_ = false;
+    // A cancelled timer must not move the clock to its run time.
+    while (!tasks_.empty() && tasks_.top().task.IsCancelled())
+      tasks_.pop();
+    if (tasks_.empty())
+      return;
+    PendingTask pending_task = tasks_.top();
+    tasks_.pop();
+    if (pending_task.run_time > now_)
+      now_ = pending_task.run_time;
+    task = pending_task.task;
+    // Give the real work of the thread a chance to run between tasks.
+    ScheduleRunLocked();
+  }
+  task.Run();
+}
+
+}  // namespace brightray
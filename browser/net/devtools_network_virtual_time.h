@@ -0,0 +1,98 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_DEVTOOLS_NETWORK_VIRTUAL_TIME_H_
+#define BROWSER_DEVTOOLS_NETWORK_VIRTUAL_TIME_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/single_thread_task_runner.h"
+#include "base/synchronization/lock.h"
+#include "base/time/tick_clock.h"
+#include "base/time/time.h"
+
+namespace brightray {
+
+// A task runner with its own clock for running network emulation in virtual
+// time. Instead of waiting for a delayed task the clock jumps to its run time,
+// so throttled transfers complete as soon as the real network allows while
+// the interceptors still account the emulated durations. Tasks run one at a
+// time on |task_runner|, interleaved with the real work of its thread.
+// Cancelled tasks, e.g. bound to an invalidated WeakPtr, are dropped without
+// advancing the clock.
+class DevToolsNetworkVirtualTime : public base::SingleThreadTaskRunner {
+ public:
+  explicit DevToolsNetworkVirtualTime(
+      scoped_refptr<base::SingleThreadTaskRunner> task_runner);
+
+  // The clock is owned by the task runner.
+  base::TickClock* clock() { return &clock_; }
+
+  // base::SingleThreadTaskRunner:
+  bool PostDelayedTask(const tracked_objects::Location& from_here,
+                       const base::Closure& task,
+                       base::TimeDelta delay) override;
+  bool PostNonNestableDelayedTask(const tracked_objects::Location& from_here,
+                                  const base::Closure& task,
+                                  base::TimeDelta delay) override;
+  bool RunsTasksOnCurrentThread() const override;
+
+ private:
+  class Clock : public base::TickClock {
+   public:
+    explicit Clock(DevToolsNetworkVirtualTime* owner);
+    ~Clock() override;
+
+    // base::TickClock:
+    base::TimeTicks NowTicks() override;
+
+   private:
+    DevToolsNetworkVirtualTime* owner_;
+
+    DISALLOW_COPY_AND_ASSIGN(Clock);
+  };
+
+  struct PendingTask {
+    PendingTask();
+    PendingTask(const PendingTask& other);
+    ~PendingTask();
+
+    // Earliest run time first, then posting order.
+    bool operator>(const PendingTask& other) const;
+
+    base::TimeTicks run_time;
+    uint64_t sequence;
+    base::Closure task;
+  };
+
+  ~DevToolsNetworkVirtualTime() override;
+
+  base::TimeTicks Now();
+  // Must be called with |lock_| held.
+  void ScheduleRunLocked();
+  void RunNextTask();
+
+  scoped_refptr<base::SingleThreadTaskRunner> task_runner_;
+  Clock clock_;
+
+  base::Lock lock_;
+  base::TimeTicks now_;
+  uint64_t next_sequence_;
+  bool run_scheduled_;
+  std::priority_queue<PendingTask,
+                      std::vector<PendingTask>,
+                      std::greater<PendingTask>> tasks_;
+
+  DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkVirtualTime);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_DEVTOOLS_NETWORK_VIRTUAL_TIME_H_
@@ -0,0 +1,66 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/devtools_network_websocket_create_helper.h"
+
+#include <utility>
+
+#include "browser/net/devtools_network_interceptor.h"
+#include "browser/net/devtools_network_stream_socket.h"
+#include "net/socket/client_socket_handle.h"
+
+namespace brightray {
+
+DevToolsNetworkWebSocketCreateHelper::DevToolsNetworkWebSocketCreateHelper(
+    net::WebSocketHandshakeStreamBase::CreateHelper* create_helper)
+    : create_helper_(create_helper),
+      transaction_id_(0),
+      socket_throttled_(false) {
+}
+
+DevToolsNetworkWebSocketCreateHelper::~DevToolsNetworkWebSocketCreateHelper() {
+}
+
+void DevToolsNetworkWebSocketCreateHelper::SetInterceptor(
+    DevToolsNetworkInterceptor* interceptor, uint64_t transaction_id) {
+  DCHECK(!interceptor_);
+  if (interceptor)
+    interceptor_ = interceptor->GetWeakPtr();
+  transaction_id_ = transaction_id;
+}
+
+net::WebSocketHandshakeStreamBase*
+DevToolsNetworkWebSocketCreateHelper::CreateBasicStream(
+    std::unique_ptr<net::ClientSocketHandle> connection,
+    bool using_proxy) {
+  if (interceptor_ && connection->socket()) {
+    DevToolsNetworkInterceptor::Connection socket_connection;
+    socket_connection.socket_id = connection->socket()->NetLog().source().id;
+    socket_connection.is_new = !connection->is_reused();
+    socket_connection.resolved_host =
+        !connection->connect_timing().dns_start.is_null();
+    socket_connection.secure =
+        !connection->connect_timing().ssl_start.is_null();
+    std::unique_ptr<net::StreamSocket> socket(new DevToolsNetworkStreamSocket(
+        connection->PassSocket(), interceptor_.get(), transaction_id_,
+        socket_connection));
+    connection->SetSocket(std::move(socket));
+    socket_throttled_ = true;
+  }
+  return create_helper_->CreateBasicStream(std::move(connection), using_proxy);
+}
+
+net::WebSocketHandshakeStreamBase*
+DevToolsNetworkWebSocketCreateHelper::CreateSpdyStream(
+    const base::WeakPtr<net::SpdySession>& session,
+    bool use_relative_url) {
+  // WebSockets over HTTP/2 share the session of other streams, so only their
+  // handshake is throttled, by the transaction. The frames go through
+  // untouched, which the DevTools client sees in the statistics.
+  if (interceptor_)
+    interceptor_->ReportUnthrottledWebSocket();
+  return create_helper_->CreateSpdyStream(session, use_relative_url);
+}
+
+}  // namespace brightray
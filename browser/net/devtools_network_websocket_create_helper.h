@@ -0,0 +1,55 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_DEVTOOLS_NETWORK_WEBSOCKET_CREATE_HELPER_H_
+#define BROWSER_DEVTOOLS_NETWORK_WEBSOCKET_CREATE_HELPER_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "net/websockets/websocket_handshake_stream_base.h"
+
+namespace brightray {
+
+class DevToolsNetworkInterceptor;
+
+// Wraps the socket of a WebSocket handshake stream, so the frames keep being
+// throttled once the stream has been upgraded and the transaction is gone.
+class DevToolsNetworkWebSocketCreateHelper
+    : public net::WebSocketHandshakeStreamBase::CreateHelper {
+ public:
+  // Supplied |create_helper| must outlive this object.
+  explicit DevToolsNetworkWebSocketCreateHelper(
+      net::WebSocketHandshakeStreamBase::CreateHelper* create_helper);
+  ~DevToolsNetworkWebSocketCreateHelper() override;
+
+  void SetInterceptor(DevToolsNetworkInterceptor* interceptor,
+                      uint64_t transaction_id);
+
+  // Whether the socket of the stream is throttled, the handshake included.
+  bool socket_throttled() const { return socket_throttled_; }
+
+  // net::WebSocketHandshakeStreamBase::CreateHelper:
+  net::WebSocketHandshakeStreamBase* CreateBasicStream(
+      std::unique_ptr<net::ClientSocketHandle> connection,
+      bool using_proxy) override;
+  net::WebSocketHandshakeStreamBase* CreateSpdyStream(
+      const base::WeakPtr<net::SpdySession>& session,
+      bool use_relative_url) override;
+
+ private:
+  net::WebSocketHandshakeStreamBase::CreateHelper* create_helper_;
+  base::WeakPtr<DevToolsNetworkInterceptor> interceptor_;
+  uint64_t transaction_id_;
+  bool socket_throttled_;
+
+  DISALLOW_COPY_AND_ASSIGN(DevToolsNetworkWebSocketCreateHelper);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_DEVTOOLS_NETWORK_WEBSOCKET_CREATE_HELPER_H_
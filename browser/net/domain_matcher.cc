@@ -0,0 +1,52 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/domain_matcher.h"
+
+#include "base/strings/string_util.h"
+#include "url/gurl.h"
+
+namespace brightray {
+
+DomainMatcher::DomainMatcher() {
+}
+
+DomainMatcher::DomainMatcher(const std::vector<std::string>& domains) {
+  domains_.reserve(domains.size());
+  for (const auto& domain : domains) {
+    base::StringPiece trimmed =
+        base::TrimString(domain, ".", base::TRIM_ALL);
+    if (!trimmed.empty())
+      domains_.push_back(base::ToLowerASCII(trimmed));
+  }
+  for (const auto& domain : domains_)
+    domain_set_.insert(domain);
+}
+
+DomainMatcher::~DomainMatcher() {
+}
+
+bool DomainMatcher::Matches(base::StringPiece host) const {
+  if (domain_set_.empty())
+    return false;
+
+  if (host.ends_with("."))
+    host.remove_suffix(1);
+  // Try the host, then each of its parent domains.
+  while (!host.empty()) {
+    if (domain_set_.count(host))
+      return true;
+    size_t dot = host.find('.');
+    if (dot == base::StringPiece::npos)
+      break;
+    host.remove_prefix(dot + 1);
+  }
+  return false;
+}
+
+bool DomainMatcher::Matches(const GURL& url) const {
+  return Matches(url.host_piece());
+}
+
+}  // namespace brightray
@@ -0,0 +1,45 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_DOMAIN_MATCHER_H_
+#define BROWSER_DOMAIN_MATCHER_H_
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+class GURL;
+
+namespace brightray {
+
+// Tells whether a host is one of a list of domains or a subdomain of one, as
+// GURL::DomainIs() does for a single domain. A lookup costs one hash per label
+// of the host, whatever the size of the list.
+class DomainMatcher {
+ public:
+  DomainMatcher();
+  explicit DomainMatcher(const std::vector<std::string>& domains);
+  ~DomainMatcher();
+
+  bool empty() const { return domains_.empty(); }
+
+  // |host| must be canonical, as returned by GURL::host_piece().
+  bool Matches(base::StringPiece host) const;
+  bool Matches(const GURL& url) const;
+
+ private:
+  // Lower case, without leading or trailing dots.
+  std::vector<std::string> domains_;
+  // Points into |domains_|, which is not modified once built.
+  std::unordered_set<base::StringPiece, base::StringPieceHash> domain_set_;
+
+  DISALLOW_COPY_AND_ASSIGN(DomainMatcher);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_DOMAIN_MATCHER_H_
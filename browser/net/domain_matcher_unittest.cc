@@ -0,0 +1,43 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/domain_matcher.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace brightray {
+
+TEST(DomainMatcherTest, Empty) {
+  DomainMatcher matcher;
+  EXPECT_TRUE(matcher.empty());
+  EXPECT_FALSE(matcher.Matches("example.com"));
+
+  // Domains made of dots only are dropped.
+  EXPECT_TRUE(DomainMatcher({"", "."}).empty());
+}
+
+TEST(DomainMatcherTest, MatchesSubdomains) {
+  DomainMatcher matcher({"example.com", ".Example.org."});
+  EXPECT_FALSE(matcher.empty());
+
+  EXPECT_TRUE(matcher.Matches("example.com"));
+  EXPECT_TRUE(matcher.Matches("a.b.example.com"));
+  EXPECT_TRUE(matcher.Matches("example.org"));
+  EXPECT_TRUE(matcher.Matches("www.example.org."));
+
+  EXPECT_FALSE(matcher.Matches("notexample.com"));
+  EXPECT_FALSE(matcher.Matches("example.com.evil.net"));
+  EXPECT_FALSE(matcher.Matches("com"));
+  EXPECT_FALSE(matcher.Matches(""));
+}
+
+TEST(DomainMatcherTest, MatchesURL) {
+  DomainMatcher matcher({"example.com"});
+  EXPECT_TRUE(matcher.Matches(GURL("https://WWW.EXAMPLE.COM/path")));
+  EXPECT_FALSE(matcher.Matches(GURL("https://example.net/example.com")));
+  EXPECT_FALSE(matcher.Matches(GURL()));
+}
+
+}  // namespace brightray
@@ -0,0 +1,205 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/host_cache_persister.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/memory/ptr_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+#include "components/prefs/pref_registry_simple.h"
+#include "components/prefs/pref_service.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/address_family.h"
+#include "net/base/address_list.h"
+#include "net/base/ip_address.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_errors.h"
+#include "net/dns/host_cache.h"
+
+using content::BrowserThread;
+
+namespace brightray {
+
+namespace {
+
+const char kHostCache[] = "net.host_cache";
+
+// How often the cache is saved, the preferences batch the writes to disk.
+const int kSaveIntervalSeconds = 60;
+
+// The first save happens once the names needed at startup have been resolved,
+// so that a short run still saves them.
+const int kFirstSaveDelaySeconds = 10;
+
+// Entries past this count are not saved.
+const size_t kMaxSavedEntries = 500;
+
+// Keys of the entries listed by net::HostCache, the saved entries use the
+// same ones.
+const char kHostname[] = "hostname";
+const char kAddressFamily[] = "address_family";
+const char kAddresses[] = "addresses";
+const char kExpiration[] = "expiration";
+const char kError[] = "error";
+
+}  // namespace
+
+HostCachePersister::HostCachePersister(PrefService* pref_service)
+    : pref_service_(pref_service),
+      saved_entries_(pref_service->GetList(kHostCache)->CreateDeepCopy()),
+      cache_(nullptr),
+      ui_weak_factory_(this) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  ui_weak_ptr_ = ui_weak_factory_.GetWeakPtr();
+}
+
+HostCachePersister::~HostCachePersister() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+}
+
+// static
+void HostCachePersister::RegisterPrefs(PrefRegistrySimple* registry) {
+  registry->RegisterListPref(kHostCache);
+}
+
+// static
+std::unique_ptr<base::ListValue> HostCachePersister::SnapshotCache(
+    const net::HostCache& cache) {
+  // The cache lists expirations as milliseconds of the monotonic clock, which
+  // means nothing to the next run, so they are saved as wall clock times.
+  base::ListValue cache_entries;
+  cache.GetAsListValue(&cache_entries, false);
+
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::Time wall_now = base::Time::Now();
+  std::unique_ptr<base::ListValue> entries(new base::ListValue);
+  for (size_t i = 0; i < cache_entries.GetSize(); ++i) {
+    const base::DictionaryValue* entry = nullptr;
+    std::string hostname;
+    int address_family = 0;
+    std::string expiration;
+    const base::ListValue* addresses = nullptr;
+    int64_t expiration_ms = 0;
+    if (!cache_entries.GetDictionary(i, &entry) ||
+        !entry->GetString(kHostname, &hostname) ||
+        !entry->GetInteger(kAddressFamily, &address_family) ||
+        !entry->GetString(kExpiration, &expiration) ||
+        !base::StringToInt64(expiration, &expiration_ms) ||
+        entry->HasKey(kError) ||
+        !entry->GetList(kAddresses, &addresses)) {
+      continue;
+    }
+
+    base::TimeDelta ttl = base::TimeTicks() +
+        base::TimeDelta::FromMilliseconds(expiration_ms) - now;
+    if (ttl <= base::TimeDelta())
+      continue;
+
+    std::unique_ptr<base::DictionaryValue> saved(new base::DictionaryValue);
+    saved->SetString(kHostname, hostname);
+    saved->SetInteger(kAddressFamily, address_family);
+    saved->Set(kAddresses, addresses->CreateDeepCopy());
+    saved->SetString(kExpiration,
+                     base::Int64ToString((wall_now + ttl).ToInternalValue()));
+    entries->Append(std::move(saved));
+    if (entries->GetSize() >= kMaxSavedEntries)
+      break;
+  }
+  return entries;
+}
+
+// static
+void HostCachePersister::RestoreCache(const base::ListValue& entries,
+                                      net::HostCache* cache) {
+  base::TimeTicks now = base::TimeTicks::Now();
+  base::Time wall_now = base::Time::Now();
+  for (size_t i = 0; i < entries.GetSize(); ++i) {
+    const base::DictionaryValue* entry = nullptr;
+    std::string hostname;
+    int address_family = 0;
+    std::string expiration;
+    const base::ListValue* addresses = nullptr;
+    int64_t expiration_value = 0;
+    if (!entries.GetDictionary(i, &entry) ||
+        !entry->GetString(kHostname, &hostname) ||
+        !entry->GetInteger(kAddressFamily, &address_family) ||
+        address_family < net::ADDRESS_FAMILY_UNSPECIFIED ||
+        address_family > net::ADDRESS_FAMILY_LAST ||
+        !entry->GetString(kExpiration, &expiration) ||
+        !base::StringToInt64(expiration, &expiration_value) ||
+        !entry->GetList(kAddresses, &addresses)) {
+      continue;
+    }
+
+    // Only the rest of the TTL is left to the restored entry.
+    base::TimeDelta ttl =
+        base::Time::FromInternalValue(expiration_value) - wall_now;
+    if (ttl <= base::TimeDelta())
+      continue;
+
+    net::AddressList address_list;
+    for (size_t j = 0; j < addresses->GetSize(); ++j) {
+      std::string literal;
+      net::IPAddress address;
+      if (addresses->GetString(j, &literal) &&
+          address.AssignFromIPLiteral(literal)) {
+        address_list.push_back(net::IPEndPoint(address, 0));
+      }
+    }
+    if (address_list.empty())
+      continue;
+
+    net::HostCache::Key key(
+        hostname, static_cast<net::AddressFamily>(address_family), 0);
+    cache->Set(key, net::HostCache::Entry(net::OK, address_list, ttl), now,
+               ttl);
+  }
+}
+
+void HostCachePersister::InitializeOnIOThread(net::HostCache* cache) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+
+  std::unique_ptr<base::ListValue> saved_entries = std::move(saved_entries_);
+  cache_ = cache;
+  if (!cache_)
+    return;
+
+  RestoreCache(*saved_entries, cache_);
+  first_save_timer_.reset(new base::OneShotTimer);
+  first_save_timer_->Start(FROM_HERE,
+                           base::TimeDelta::FromSeconds(kFirstSaveDelaySeconds),
+                           base::Bind(&HostCachePersister::SaveOnIOThread,
+                                      base::Unretained(this)));
+  save_timer_.reset(new base::RepeatingTimer);
+  save_timer_->Start(FROM_HERE,
+                     base::TimeDelta::FromSeconds(kSaveIntervalSeconds),
+                     base::Bind(&HostCachePersister::SaveOnIOThread,
+                                base::Unretained(this)));
+}
+
+void HostCachePersister::ShutdownOnUIThread() {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  ui_weak_factory_.InvalidateWeakPtrs();
+  pref_service_ = nullptr;
+}
+
+void HostCachePersister::SaveOnIOThread() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(&HostCachePersister::WriteOnUIThread, ui_weak_ptr_,
+                 base::Passed(SnapshotCache(*cache_))));
+}
+
+void HostCachePersister::WriteOnUIThread(
+    std::unique_ptr<base::ListValue> entries) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  // Setting an unchanged value does not write anything.
+  pref_service_->Set(kHostCache, *entries);
+}
+
+}  // namespace brightray
@@ -0,0 +1,78 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_HOST_CACHE_PERSISTER_H_
+#define BROWSER_HOST_CACHE_PERSISTER_H_
+
+#include <memory>
+
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/timer/timer.h"
+
+class PrefRegistrySimple;
+class PrefService;
+
+namespace base {
+class ListValue;
+}
+
+namespace net {
+class HostCache;
+}
+
+namespace brightray {
+
+// Keeps the entries of a partition's host cache in its preferences, so that
+// names resolved by a previous run are known at startup until their TTL
+// expires. Created on the UI thread, then used on the IO thread where it is
+// destroyed.
+class HostCachePersister {
+ public:
+  explicit HostCachePersister(PrefService* pref_service);
+  ~HostCachePersister();
+
+  static void RegisterPrefs(PrefRegistrySimple* pref_registry);
+
+  // Lists the entries of |cache| which have not expired, with wall clock
+  // expirations. Exposed for testing.
+  static std::unique_ptr<base::ListValue> SnapshotCache(
+      const net::HostCache& cache);
+  // Adds the saved |entries| which have not expired to |cache|. Exposed for
+  // testing.
+  static void RestoreCache(const base::ListValue& entries,
+                           net::HostCache* cache);
+
+  // Called on the IO thread. Restores the entries which have not expired and
+  // saves the cache shortly after, then periodically. Nothing is saved when
+  // the persister is destroyed since the preferences are already gone.
+  void InitializeOnIOThread(net::HostCache* cache);
+
+  // Called on the UI thread before the preferences are destroyed.
+  void ShutdownOnUIThread();
+
+ private:
+  void SaveOnIOThread();
+  void WriteOnUIThread(std::unique_ptr<base::ListValue> entries);
+
+  // Only used on the UI thread.
+  PrefService* pref_service_;
+  // Read from the preferences when created.
+  std::unique_ptr<base::ListValue> saved_entries_;
+
+  // Only used on the IO thread.
+  net::HostCache* cache_;
+  std::unique_ptr<base::OneShotTimer> first_save_timer_;
+  std::unique_ptr<base::RepeatingTimer> save_timer_;
+
+  // Bound to the UI thread, invalidated by ShutdownOnUIThread().
+  base::WeakPtrFactory<HostCachePersister> ui_weak_factory_;
+  base::WeakPtr<HostCachePersister> ui_weak_ptr_;
+
+  DISALLOW_COPY_AND_ASSIGN(HostCachePersister);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_HOST_CACHE_PERSISTER_H_
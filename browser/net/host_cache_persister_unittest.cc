@@ -0,0 +1,115 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/host_cache_persister.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "net/base/address_family.h"
+#include "net/base/address_list.h"
+#include "net/base/ip_address.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_errors.h"
+#include "net/dns/host_cache.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brightray {
+
+namespace {
+
+net::HostCache::Key Key(const std::string& hostname) {
+  return net::HostCache::Key(hostname, net::ADDRESS_FAMILY_UNSPECIFIED, 0);
+}
+
+net::AddressList Addresses(const std::string& literal) {
+  net::IPAddress address;
+  EXPECT_TRUE(address.AssignFromIPLiteral(literal));
+  return net::AddressList(net::IPEndPoint(address, 0));
+}
+
+void Set(net::HostCache* cache,
+         const std::string& hostname,
+         int error,
+         base::TimeDelta ttl) {
+  cache->Set(Key(hostname),
+             net::HostCache::Entry(error, Addresses("10.0.0.1"), ttl),
+             base::TimeTicks::Now(), ttl);
+}
+
+std::unique_ptr<base::DictionaryValue> SavedEntry(const std::string& hostname,
+                                                  const std::string& address,
+                                                  base::Time expiration) {
+  std::unique_ptr<base::DictionaryValue> entry(new base::DictionaryValue);
+  entry->SetString("hostname", hostname);
+  entry->SetInteger("address_family", net::ADDRESS_FAMILY_UNSPECIFIED);
+  std::unique_ptr<base::ListValue> addresses(new base::ListValue);
+  addresses->AppendString(address);
+  entry->Set("addresses", std::move(addresses));
+  entry->SetString("expiration",
+                   base::Int64ToString(expiration.ToInternalValue()));
+  return entry;
+}
+
+}  // namespace
+
+TEST(HostCachePersisterTest, SnapshotSkipsErrors) {
+  net::HostCache cache(10);
+  Set(&cache, "example.com", net::OK, base::TimeDelta::FromHours(1));
+  Set(&cache, "missing.example.com", net::ERR_NAME_NOT_RESOLVED,
+      base::TimeDelta::FromHours(1));
+
+  std::unique_ptr<base::ListValue> entries =
+      HostCachePersister::SnapshotCache(cache);
+  ASSERT_EQ(1u, entries->GetSize());
+
+  const base::DictionaryValue* entry = nullptr;
+  std::string hostname;
+  ASSERT_TRUE(entries->GetDictionary(0, &entry));
+  EXPECT_TRUE(entry->GetString("hostname", &hostname));
+  EXPECT_EQ("example.com", hostname);
+}
+
+TEST(HostCachePersisterTest, SnapshotAndRestore) {
+  net::HostCache cache(10);
+  Set(&cache, "example.com", net::OK, base::TimeDelta::FromHours(1));
+  std::unique_ptr<base::ListValue> entries =
+      HostCachePersister::SnapshotCache(cache);
+
+  net::HostCache restored(10);
+  HostCachePersister::RestoreCache(*entries, &restored);
+  const net::HostCache::Entry* entry =
+      restored.Lookup(Key("example.com"), base::TimeTicks::Now());
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(net::OK, entry->error());
+  ASSERT_EQ(1u, entry->addresses().size());
+  EXPECT_EQ("10.0.0.1", entry->addresses().front().ToStringWithoutPort());
+
+  // The restored entry only keeps the rest of the TTL.
+  EXPECT_LE(entry->ttl(), base::TimeDelta::FromHours(1));
+  EXPECT_FALSE(restored.Lookup(
+      Key("example.com"),
+      base::TimeTicks::Now() + base::TimeDelta::FromHours(2)));
+}
+
+TEST(HostCachePersisterTest, RestoreSkipsInvalidEntries) {
+  base::Time later = base::Time::Now() + base::TimeDelta::FromHours(1);
+  base::ListValue entries;
+  entries.Append(SavedEntry("valid.example.com", "10.0.0.2", later));
+  entries.Append(SavedEntry("expired.example.com", "10.0.0.3",
+                            base::Time::Now() - base::TimeDelta::FromHours(1)));
+  entries.Append(SavedEntry("bad.example.com", "not an address", later));
+  entries.AppendString("not an entry");
+
+  net::HostCache cache(10);
+  HostCachePersister::RestoreCache(entries, &cache);
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_TRUE(cache.Lookup(Key("valid.example.com"), base::TimeTicks::Now()));
+}
+
+}  // namespace brightray
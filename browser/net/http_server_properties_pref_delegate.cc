@@ -0,0 +1,57 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/http_server_properties_pref_delegate.h"
+
+#include "base/values.h"
+#include "components/prefs/pref_registry_simple.h"
+#include "components/prefs/pref_service.h"
+
+namespace brightray {
+
+namespace {
+
+const char kHttpServerProperties[] = "net.http_server_properties";
+
+}  // namespace
+
+HttpServerPropertiesPrefDelegate::HttpServerPropertiesPrefDelegate(
+    PrefService* pref_service)
+    : pref_service_(pref_service) {
+  pref_change_registrar_.Init(pref_service_);
+}
+
+HttpServerPropertiesPrefDelegate::~HttpServerPropertiesPrefDelegate() {
+}
+
+// static
+void HttpServerPropertiesPrefDelegate::RegisterPrefs(
+    PrefRegistrySimple* registry) {
+  registry->RegisterDictionaryPref(kHttpServerProperties);
+}
+
+bool HttpServerPropertiesPrefDelegate::HasServerProperties() {
+  return pref_service_->HasPrefPath(kHttpServerProperties);
+}
+
+const base::DictionaryValue&
+HttpServerPropertiesPrefDelegate::GetServerProperties() const {
+  return *pref_service_->GetDictionary(kHttpServerProperties);
+}
+
+void HttpServerPropertiesPrefDelegate::SetServerProperties(
+    const base::DictionaryValue& value) {
+  pref_service_->Set(kHttpServerProperties, value);
+}
+
+void HttpServerPropertiesPrefDelegate::StartListeningForUpdates(
+    const base::Closure& callback) {
+  pref_change_registrar_.Add(kHttpServerProperties, callback);
+}
+
+void HttpServerPropertiesPrefDelegate::StopListeningForUpdates() {
+  pref_change_registrar_.RemoveAll();
+}
+
+}  // namespace brightray
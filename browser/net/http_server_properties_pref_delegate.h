@@ -0,0 +1,44 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_HTTP_SERVER_PROPERTIES_PREF_DELEGATE_H_
+#define BROWSER_HTTP_SERVER_PROPERTIES_PREF_DELEGATE_H_
+
+#include "base/macros.h"
+#include "components/prefs/pref_change_registrar.h"
+#include "net/http/http_server_properties_manager.h"
+
+class PrefRegistrySimple;
+class PrefService;
+
+namespace brightray {
+
+// Stores the HTTP server properties learned by a partition, such as HTTP/2
+// support, alternative services and server RTTs, in its preferences. Lives
+// on the UI thread.
+class HttpServerPropertiesPrefDelegate
+    : public net::HttpServerPropertiesManager::PrefDelegate {
+ public:
+  explicit HttpServerPropertiesPrefDelegate(PrefService* pref_service);
+  ~HttpServerPropertiesPrefDelegate() override;
+
+  static void RegisterPrefs(PrefRegistrySimple* pref_registry);
+
+  // net::HttpServerPropertiesManager::PrefDelegate:
+  bool HasServerProperties() override;
+  const base::DictionaryValue& GetServerProperties() const override;
+  void SetServerProperties(const base::DictionaryValue& value) override;
+  void StartListeningForUpdates(const base::Closure& callback) override;
+  void StopListeningForUpdates() override;
+
+ private:
+  PrefService* pref_service_;
+  PrefChangeRegistrar pref_change_registrar_;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpServerPropertiesPrefDelegate);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_HTTP_SERVER_PROPERTIES_PREF_DELEGATE_H_
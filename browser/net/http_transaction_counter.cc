@@ -0,0 +1,38 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/http_transaction_counter.h"
+
+#include <utility>
+
+#include "net/http/http_transaction.h"
+
+namespace brightray {
+
+HttpTransactionCounter::HttpTransactionCounter(
+    std::unique_ptr<net::HttpTransactionFactory> factory)
+    : factory_(std::move(factory)),
+      count_(0) {
+}
+
+HttpTransactionCounter::~HttpTransactionCounter() {
+}
+
+int HttpTransactionCounter::CreateTransaction(
+    net::RequestPriority priority,
+    std::unique_ptr<net::HttpTransaction>* transaction) {
+  if (count_++ == 0)
+    first_transaction_time_ = base::TimeTicks::Now();
+  return factory_->CreateTransaction(priority, transaction);
+}
+
+net::HttpCache* HttpTransactionCounter::GetCache() {
+  return factory_->GetCache();
+}
+
+net::HttpNetworkSession* HttpTransactionCounter::GetSession() {
+  return factory_->GetSession();
+}
+
+}  // namespace brightray
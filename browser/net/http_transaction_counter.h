@@ -0,0 +1,50 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_HTTP_TRANSACTION_COUNTER_H_
+#define BROWSER_HTTP_TRANSACTION_COUNTER_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "net/base/request_priority.h"
+#include "net/http/http_transaction_factory.h"
+
+namespace brightray {
+
+// Counts the transactions created by |factory|. Placed under an HTTP cache it
+// tells how many requests the cache could not answer by itself.
+class HttpTransactionCounter : public net::HttpTransactionFactory {
+ public:
+  explicit HttpTransactionCounter(
+      std::unique_ptr<net::HttpTransactionFactory> factory);
+  ~HttpTransactionCounter() override;
+
+  int64_t count() const { return count_; }
+  // Null until the first transaction is created.
+  base::TimeTicks first_transaction_time() const {
+    return first_transaction_time_;
+  }
+
+  // net::HttpTransactionFactory:
+  int CreateTransaction(
+      net::RequestPriority priority,
+      std::unique_ptr<net::HttpTransaction>* transaction) override;
+  net::HttpCache* GetCache() override;
+  net::HttpNetworkSession* GetSession() override;
+
+ private:
+  std::unique_ptr<net::HttpTransactionFactory> factory_;
+  int64_t count_;
+  base::TimeTicks first_transaction_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpTransactionCounter);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_HTTP_TRANSACTION_COUNTER_H_
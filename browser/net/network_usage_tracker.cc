@@ -0,0 +1,140 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/network_usage_tracker.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/supports_user_data.h"
+#include "content/public/browser/resource_request_info.h"
+#include "net/url_request/url_request.h"
+#include "url/origin.h"
+
+using content::BrowserThread;
+
+namespace brightray {
+
+namespace {
+
+// Past this count of origin and resource type pairs, the new origins are
+// accounted together so that a partition talking to many hosts does not grow
+// the maps without bound.
+const size_t kMaxEntries = 200;
+
+// How long the counts wait on the IO thread before being merged.
+const int kFlushDelaySeconds = 5;
+
+const char kRequestUsageKey[] = "NetworkUsageTracker";
+
+// The entry of a request in the pending counts, so that its key is only
+// built once.
+struct RequestUsage : public base::SupportsUserData::Data {
+  // Length of the URL chain of the request when |key| was built.
+  size_t url_chain_size = 0;
+  uint64_t flush_count = 0;
+  NetworkUsageTracker::Bytes* bytes = nullptr;
+};
+
+}  // namespace
+
+NetworkUsageTracker::Key::Key(const std::string& origin, int resource_type)
+    : origin(origin), resource_type(resource_type) {
+}
+
+NetworkUsageTracker::Bytes::Bytes() : received(0), sent(0) {
+}
+
+NetworkUsageTracker::NetworkUsageTracker()
+    : pending_(new UsageMap),
+      flush_scheduled_(false),
+      flush_count_(0) {
+}
+
+NetworkUsageTracker::~NetworkUsageTracker() {
+}
+
+void NetworkUsageTracker::RecordBytesReceived(net::URLRequest* request,
+                                              int64_t bytes) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  GetPendingBytes(request)->received += bytes;
+}
+
+void NetworkUsageTracker::RecordBytesSent(net::URLRequest* request,
+                                          int64_t bytes) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  GetPendingBytes(request)->sent += bytes;
+}
+
+// static
+NetworkUsageTracker::Bytes* NetworkUsageTracker::GetBytes(const Key& key,
+                                                          UsageMap* usage) {
+  auto it = usage->find(key);
+  if (it != usage->end())
+    return &it->second;
+  if (usage->size() >= kMaxEntries)
+    return &(*usage)[Key(std::string(), key.resource_type)];
+  return &(*usage)[key];
+}
+
+NetworkUsageTracker::Bytes* NetworkUsageTracker::GetPendingBytes(
+    net::URLRequest* request) {
+  if (!flush_scheduled_) {
+    flush_scheduled_ = true;
+    BrowserThread::PostDelayedTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&NetworkUsageTracker::FlushOnIOThread, this),
+        base::TimeDelta::FromSeconds(kFlushDelaySeconds));
+  }
+
+  RequestUsage* usage =
+      static_cast<RequestUsage*>(request->GetUserData(kRequestUsageKey));
+  if (!usage) {
+    usage = new RequestUsage;
+    request->SetUserData(kRequestUsageKey, usage);
+  }
+  // The entries of |pending_| stay in place until it is flushed.
+  if (usage->bytes && usage->flush_count == flush_count_ &&
+      usage->url_chain_size == request->url_chain().size()) {
+    return usage->bytes;
+  }
+
+  int resource_type = kNoResourceType;
+  const content::ResourceRequestInfo* info =
+      content::ResourceRequestInfo::ForRequest(request);
+  if (info)
+    resource_type = info->GetResourceType();
+
+  usage->url_chain_size = request->url_chain().size();
+  usage->flush_count = flush_count_;
+  usage->bytes = GetBytes(
+      Key(url::Origin(request->url()).Serialize(), resource_type),
+      pending_.get());
+  return usage->bytes;
+}
+
+void NetworkUsageTracker::FlushOnIOThread() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  flush_scheduled_ = false;
+  ++flush_count_;
+  std::unique_ptr<UsageMap> pending(new UsageMap);
+  pending_.swap(pending);
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(&NetworkUsageTracker::MergeOnUIThread, this,
+                 base::Passed(&pending)));
+}
+
+void NetworkUsageTracker::MergeOnUIThread(std::unique_ptr<UsageMap> pending) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  for (const auto& entry : *pending) {
+    Bytes* bytes = GetBytes(entry.first, &usage_);
+    bytes->received += entry.second.received;
+    bytes->sent += entry.second.sent;
+    total_.received += entry.second.received;
+    total_.sent += entry.second.sent;
+  }
+}
+
+}  // namespace brightray
@@ -0,0 +1,103 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_NETWORK_USAGE_TRACKER_H_
+#define BROWSER_NETWORK_USAGE_TRACKER_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "content/public/browser/browser_thread.h"
+
+namespace net {
+class URLRequest;
+}
+
+namespace brightray {
+
+// Bytes sent and received over the network by the requests of a partition,
+// per origin and resource type. The network delegate counts them on the IO
+// thread and the counts are merged on the UI thread every few seconds, so
+// neither side takes a lock.
+class NetworkUsageTracker
+    : public base::RefCountedThreadSafe<
+          NetworkUsageTracker,
+          content::BrowserThread::DeleteOnIOThread> {
+ public:
+  // Resource type of the requests which were not made by a renderer.
+  static const int kNoResourceType = -1;
+
+  struct Key {
+    Key(const std::string& origin, int resource_type);
+
+    bool operator<(const Key& other) const {
+      if (origin == other.origin)
+        return resource_type < other.resource_type;
+      return origin < other.origin;
+    }
+
+    // Serialized origin, empty for the origins past the limit.
+    std::string origin;
+    // A content::ResourceType, or kNoResourceType.
+    int resource_type;
+  };
+
+  struct Bytes {
+    Bytes();
+
+    int64_t received;
+    int64_t sent;
+  };
+
+  using UsageMap = std::map<Key, Bytes>;
+
+  NetworkUsageTracker();
+
+  // Called on the IO thread. The key of |request| is cached on it until it is
+  // redirected.
+  void RecordBytesReceived(net::URLRequest* request, int64_t bytes);
+  void RecordBytesSent(net::URLRequest* request, int64_t bytes);
+
+  // Called on the UI thread. The usage since the partition was created, up to
+  // the last merge.
+  const UsageMap& usage() const { return usage_; }
+  const Bytes& total() const { return total_; }
+
+ private:
+  friend struct content::BrowserThread::DeleteOnThread<
+      content::BrowserThread::IO>;
+  friend class base::DeleteHelper<NetworkUsageTracker>;
+
+  ~NetworkUsageTracker();
+
+  // Returns the entry of |key|, or the one of the other origins once |usage|
+  // holds too many entries.
+  static Bytes* GetBytes(const Key& key, UsageMap* usage);
+
+  Bytes* GetPendingBytes(net::URLRequest* request);
+  void FlushOnIOThread();
+  void MergeOnUIThread(std::unique_ptr<UsageMap> pending);
+
+  // Only used on the IO thread.
+  std::unique_ptr<UsageMap> pending_;
+  bool flush_scheduled_;
+  // Incremented when |pending_| is replaced, which invalidates the entries
+  // cached on the requests.
+  uint64_t flush_count_;
+
+  // Only used on the UI thread.
+  UsageMap usage_;
+  Bytes total_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetworkUsageTracker);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_NETWORK_USAGE_TRACKER_H_
@@ -0,0 +1,207 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/preconnect_manager.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/values.h"
+#include "components/prefs/pref_registry_simple.h"
+#include "components/prefs/pref_service.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/layered_network_delegate.h"
+#include "net/base/load_flags.h"
+#include "net/http/http_network_session.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_request_info.h"
+#include "net/http/http_stream_factory.h"
+#include "net/http/http_transaction_factory.h"
+#include "net/url_request/http_user_agent_settings.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_context.h"
+
+using content::BrowserThread;
+
+namespace brightray {
+
+namespace {
+
+const char kPreconnectOrigins[] = "net.preconnect_origins";
+
+// The socket pools do not keep more connections to a host.
+const int kMaxSocketsPerOrigin = 6;
+
+// How often the learned origins are saved, the preferences batch the writes
+// to disk.
+const int kSaveIntervalSeconds = 60;
+
+// Origins counted per learned origin. Past that the least used half is
+// dropped, they are unlikely to make it to the learned ones.
+const size_t kCountedOriginsPerLearnedOrigin = 8;
+
+class LearningNetworkDelegate : public net::LayeredNetworkDelegate {
+ public:
+  LearningNetworkDelegate(std::unique_ptr<net::NetworkDelegate> nested,
+                          PreconnectManager* manager)
+      : net::LayeredNetworkDelegate(std::move(nested)),
+        manager_(manager) {}
+
+ private:
+  void OnResponseStartedInternal(net::URLRequest* request) override {
+    if (!request->was_cached())
+      manager_->RecordOrigin(request->url());
+  }
+
+  PreconnectManager* manager_;
+
+  DISALLOW_COPY_AND_ASSIGN(LearningNetworkDelegate);
+};
+
+}  // namespace
+
+PreconnectManager::PreconnectManager(PrefService* pref_service,
+                                     size_t max_learned_origins)
+    : max_learned_origins_(pref_service ? max_learned_origins : 0),
+      pref_service_(pref_service),
+      context_(nullptr),
+      origins_changed_(false),
+      ui_weak_factory_(this) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  if (learning()) {
+    learned_origins_ =
+        pref_service_->GetList(kPreconnectOrigins)->CreateDeepCopy();
+  }
+  ui_weak_ptr_ = ui_weak_factory_.GetWeakPtr();
+}
+
+PreconnectManager::~PreconnectManager() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+}
+
+// static
+void PreconnectManager::RegisterPrefs(PrefRegistrySimple* registry) {
+  registry->RegisterListPref(kPreconnectOrigins);
+}
+
+void PreconnectManager::InitializeOnIOThread(net::URLRequestContext* context) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  context_ = context;
+  if (!learning())
+    return;
+
+  std::unique_ptr<base::ListValue> learned_origins =
+      std::move(learned_origins_);
+  for (size_t i = 0;
+       i < learned_origins->GetSize() && i < max_learned_origins_; ++i) {
+    std::string origin;
+    if (learned_origins->GetString(i, &origin))
+      Preconnect(GURL(origin), 1);
+  }
+
+  save_timer_.reset(new base::RepeatingTimer);
+  save_timer_->Start(FROM_HERE,
+                     base::TimeDelta::FromSeconds(kSaveIntervalSeconds),
+                     base::Bind(&PreconnectManager::SaveOnIOThread,
+                                base::Unretained(this)));
+}
+
+std::unique_ptr<net::NetworkDelegate> PreconnectManager::WrapNetworkDelegate(
+    std::unique_ptr<net::NetworkDelegate> network_delegate) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  if (!learning() || !network_delegate)
+    return network_delegate;
+  return std::unique_ptr<net::NetworkDelegate>(
+      new LearningNetworkDelegate(std::move(network_delegate), this));
+}
+
+void PreconnectManager::Preconnect(const GURL& url, int num_sockets) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  if (!context_ || !url.is_valid() || !url.SchemeIsHTTPOrHTTPS())
+    return;
+
+  net::HttpTransactionFactory* factory = context_->http_transaction_factory();
+  net::HttpNetworkSession* session = factory ? factory->GetSession() : nullptr;
+  if (!session)
+    return;
+
+  net::HttpRequestInfo request_info;
+  request_info.url = url.GetOrigin();
+  request_info.method = "GET";
+  request_info.load_flags = net::LOAD_NORMAL;
+  if (context_->http_user_agent_settings()) {
+    request_info.extra_headers.SetHeader(
+        net::HttpRequestHeaders::kUserAgent,
+        context_->http_user_agent_settings()->GetUserAgent());
+  }
+  session->http_stream_factory()->PreconnectStreams(
+      std::max(1, std::min(num_sockets, kMaxSocketsPerOrigin)), request_info);
+}
+
+void PreconnectManager::RecordOrigin(const GURL& url) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  if (!url.SchemeIsHTTPOrHTTPS())
+    return;
+  GURL origin = url.GetOrigin();
+  size_t max_counted_origins =
+      max_learned_origins_ * kCountedOriginsPerLearnedOrigin;
+  if (origin_counts_.size() >= max_counted_origins &&
+      !origin_counts_.count(origin)) {
+    std::map<GURL, int> origin_counts;
+    for (const auto& origin_count :
+         GetMostUsedOrigins(max_counted_origins / 2)) {
+      origin_counts[origin_count.second] = origin_count.first;
+    }
+    origin_counts_.swap(origin_counts);
+  }
+  ++origin_counts_[origin];
+  origins_changed_ = true;
+}
+
+void PreconnectManager::ShutdownOnUIThread() {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  ui_weak_factory_.InvalidateWeakPtrs();
+  pref_service_ = nullptr;
+}
+
+void PreconnectManager::SaveOnIOThread() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  if (!origins_changed_)
+    return;
+  origins_changed_ = false;
+
+  std::unique_ptr<base::ListValue> list(new base::ListValue);
+  for (const auto& origin_count : GetMostUsedOrigins(max_learned_origins_))
+    list->AppendString(origin_count.second.spec());
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(&PreconnectManager::WriteOnUIThread, ui_weak_ptr_,
+                 base::Passed(&list)));
+}
+
+std::vector<std::pair<int, GURL>> PreconnectManager::GetMostUsedOrigins(
+    size_t count) const {
+  std::vector<std::pair<int, GURL>> origins;
+  origins.reserve(origin_counts_.size());
+  for (const auto& origin_count : origin_counts_)
+    origins.push_back(std::make_pair(origin_count.second, origin_count.first));
+  count = std::min(origins.size(), count);
+  std::partial_sort(origins.begin(), origins.begin() + count, origins.end(),
+                    [](const std::pair<int, GURL>& a,
+                       const std::pair<int, GURL>& b) {
+                      return a.first > b.first;
+                    });
+  origins.resize(count);
+  return origins;
+}
+
+void PreconnectManager::WriteOnUIThread(
+    std::unique_ptr<base::ListValue> origins) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  pref_service_->Set(kPreconnectOrigins, *origins);
+}
+
+}  // namespace brightray
@@ -0,0 +1,96 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_PRECONNECT_MANAGER_H_
+#define BROWSER_PRECONNECT_MANAGER_H_
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/timer/timer.h"
+#include "url/gurl.h"
+
+class PrefRegistrySimple;
+class PrefService;
+
+namespace base {
+class ListValue;
+}
+
+namespace net {
+class NetworkDelegate;
+class URLRequestContext;
+}
+
+namespace brightray {
+
+// Opens connections ahead of the requests of a partition. It can also learn
+// the origins most used by a session and preconnect to them on the next run.
+// Created on the UI thread, then used on the IO thread where it is destroyed.
+class PreconnectManager {
+ public:
+  // Learns up to |max_learned_origins| origins in |pref_service|, nothing is
+  // learned when it is null.
+  PreconnectManager(PrefService* pref_service, size_t max_learned_origins);
+  ~PreconnectManager();
+
+  static void RegisterPrefs(PrefRegistrySimple* pref_registry);
+
+  // Called on the IO thread once |context| is created, preconnects to the
+  // origins learned by the last session.
+  void InitializeOnIOThread(net::URLRequestContext* context);
+
+  // Called on the IO thread, returns |network_delegate| as is when nothing is
+  // learned, and otherwise a delegate recording the origins of its requests.
+  std::unique_ptr<net::NetworkDelegate> WrapNetworkDelegate(
+      std::unique_ptr<net::NetworkDelegate> network_delegate);
+
+  // Called on the IO thread, opens |num_sockets| connections to the origin of
+  // |url|, without going over the limit of connections per host.
+  void Preconnect(const GURL& url, int num_sockets);
+
+  // Called on the IO thread for every response which did not come from the
+  // cache.
+  void RecordOrigin(const GURL& url);
+
+  // Called on the UI thread before the preferences are destroyed.
+  void ShutdownOnUIThread();
+
+ private:
+  bool learning() const { return max_learned_origins_ > 0; }
+
+  void SaveOnIOThread();
+  // The |count| origins with the most responses, most used first.
+  std::vector<std::pair<int, GURL>> GetMostUsedOrigins(size_t count) const;
+  void WriteOnUIThread(std::unique_ptr<base::ListValue> origins);
+
+  const size_t max_learned_origins_;
+
+  // Only used on the UI thread.
+  PrefService* pref_service_;
+  // Read from the preferences when created.
+  std::unique_ptr<base::ListValue> learned_origins_;
+
+  // Only used on the IO thread.
+  net::URLRequestContext* context_;
+  // Responses of this session per origin, bounded to a multiple of
+  // |max_learned_origins_|.
+  std::map<GURL, int> origin_counts_;
+  bool origins_changed_;
+  std::unique_ptr<base::RepeatingTimer> save_timer_;
+
+  // Bound to the UI thread, invalidated by ShutdownOnUIThread().
+  base::WeakPtrFactory<PreconnectManager> ui_weak_factory_;
+  base::WeakPtr<PreconnectManager> ui_weak_ptr_;
+
+  DISALLOW_COPY_AND_ASSIGN(PreconnectManager);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_PRECONNECT_MANAGER_H_
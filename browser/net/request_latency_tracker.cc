@@ -0,0 +1,159 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/request_latency_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/bits.h"
+#include "net/base/load_timing_info.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_status.h"
+
+using content::BrowserThread;
+
+namespace brightray {
+
+namespace {
+
+// Buckets per power of two.
+const int kSubBucketBits = 3;
+const int64_t kSubBucketCount = 1 << kSubBucketBits;
+
+const int64_t kMaxMilliseconds = (1 << 24) - 1;
+
+// How long the recorded requests wait on the IO thread before being merged.
+const int kFlushDelaySeconds = 5;
+
+// Returns the first non-null time.
+base::TimeTicks FirstOf(base::TimeTicks a,
+                        base::TimeTicks b,
+                        base::TimeTicks c) {
+  if (!a.is_null())
+    return a;
+  return b.is_null() ? c : b;
+}
+
+}  // namespace
+
+RequestLatencyTracker::Histogram::Histogram() : count_(0) {
+  counts_.fill(0);
+}
+
+void RequestLatencyTracker::Histogram::Add(base::TimeDelta value) {
+  ++counts_[BucketIndex(value.InMilliseconds())];
+  ++count_;
+}
+
+void RequestLatencyTracker::Histogram::Merge(const Histogram& other) {
+  for (size_t i = 0; i < kBucketCount; ++i)
+    counts_[i] += other.counts_[i];
+  count_ += other.count_;
+}
+
+base::TimeDelta RequestLatencyTracker::Histogram::Percentile(
+    double fraction) const {
+  if (count_ == 0)
+    return base::TimeDelta();
+
+  fraction = std::max(0.0, std::min(fraction, 1.0));
+  int64_t rank =
+      std::max<int64_t>(1, static_cast<int64_t>(std::ceil(fraction * count_)));
+  int64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    seen += counts_[i];
+    if (seen >= rank)
+      return base::TimeDelta::FromMilliseconds(BucketUpperBound(i));
+  }
+  return base::TimeDelta::FromMilliseconds(kMaxMilliseconds);
+}
+
+// static
+size_t RequestLatencyTracker::Histogram::BucketIndex(int64_t milliseconds) {
+  milliseconds = std::max<int64_t>(0, std::min(milliseconds, kMaxMilliseconds));
+  // The values below the first power of two with all its sub-buckets get a
+  // bucket each.
+  if (milliseconds < kSubBucketCount)
+    return milliseconds;
+  int shift = base::bits::Log2Floor(static_cast<uint32_t>(milliseconds)) -
+              kSubBucketBits;
+  return kSubBucketCount * (shift + 1) +
+         ((milliseconds >> shift) - kSubBucketCount);
+}
+
+// static
+int64_t RequestLatencyTracker::Histogram::BucketUpperBound(size_t index) {
+  if (index < static_cast<size_t>(kSubBucketCount))
+    return index;
+  int shift = index / kSubBucketCount - 1;
+  int64_t sub_bucket = index % kSubBucketCount + kSubBucketCount;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+RequestLatencyTracker::RequestLatencyTracker()
+    : pending_(new Histograms),
+      flush_scheduled_(false) {
+}
+
+RequestLatencyTracker::~RequestLatencyTracker() {
+}
+
+void RequestLatencyTracker::RecordRequest(const net::URLRequest& request) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+
+  net::LoadTimingInfo timing;
+  request.GetLoadTimingInfo(&timing);
+  if (timing.request_start.is_null() || !request.status().is_success())
+    return;
+
+  Histograms& pending = *pending_;
+  const net::LoadTimingInfo::ConnectTiming& connect = timing.connect_timing;
+  base::TimeTicks first_activity =
+      FirstOf(connect.dns_start, connect.connect_start, timing.send_start);
+  if (!first_activity.is_null())
+    pending[PHASE_QUEUEING].Add(first_activity - timing.request_start);
+  if (!connect.dns_start.is_null() && !connect.dns_end.is_null())
+    pending[PHASE_DNS].Add(connect.dns_end - connect.dns_start);
+  if (!connect.connect_start.is_null() && !connect.connect_end.is_null())
+    pending[PHASE_CONNECT].Add(connect.connect_end - connect.connect_start);
+  if (!timing.send_start.is_null() && !timing.receive_headers_end.is_null()) {
+    pending[PHASE_TIME_TO_FIRST_BYTE].Add(
+        timing.receive_headers_end - timing.send_start);
+  }
+  base::TimeTicks now = base::TimeTicks::Now();
+  if (!timing.receive_headers_end.is_null())
+    pending[PHASE_DOWNLOAD].Add(now - timing.receive_headers_end);
+  pending[PHASE_TOTAL].Add(now - timing.request_start);
+
+  if (!flush_scheduled_) {
+    flush_scheduled_ = true;
+    BrowserThread::PostDelayedTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&RequestLatencyTracker::FlushOnIOThread, this),
+        base::TimeDelta::FromSeconds(kFlushDelaySeconds));
+  }
+}
+
+void RequestLatencyTracker::FlushOnIOThread() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  flush_scheduled_ = false;
+  std::unique_ptr<Histograms> pending(new Histograms);
+  pending_.swap(pending);
+  BrowserThread::PostTask(
+      BrowserThread::UI, FROM_HERE,
+      base::Bind(&RequestLatencyTracker::MergeOnUIThread, this,
+                 base::Passed(&pending)));
+}
+
+void RequestLatencyTracker::MergeOnUIThread(
+    std::unique_ptr<Histograms> pending) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  for (size_t i = 0; i < PHASE_COUNT; ++i)
+    histograms_[i].Merge((*pending)[i]);
+}
+
+}  // namespace brightray
@@ -0,0 +1,108 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_REQUEST_LATENCY_TRACKER_H_
+#define BROWSER_REQUEST_LATENCY_TRACKER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <memory>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/time/time.h"
+#include "content/public/browser/browser_thread.h"
+
+namespace net {
+class URLRequest;
+}
+
+namespace brightray {
+
+// Latency of the phases of the requests of a partition. The network delegate
+// records the requests on the IO thread and the histograms are merged on the
+// UI thread every few seconds, so neither side takes a lock.
+class RequestLatencyTracker
+    : public base::RefCountedThreadSafe<
+          RequestLatencyTracker,
+          content::BrowserThread::DeleteOnIOThread> {
+ public:
+  enum Phase {
+    // From the start of the request to its first network activity, including
+    // the cache lookup, the proxy resolution and the wait for a socket.
+    PHASE_QUEUEING,
+    PHASE_DNS,
+    // TCP and TLS handshakes.
+    PHASE_CONNECT,
+    // From sending the request to receiving the response headers.
+    PHASE_TIME_TO_FIRST_BYTE,
+    // From the response headers to the completion of the request.
+    PHASE_DOWNLOAD,
+    PHASE_TOTAL,
+    PHASE_COUNT,
+  };
+
+  // Counts durations in log-linear buckets of milliseconds, eight per power
+  // of two, so that each bucket is within 12.5% of the values it holds.
+  class Histogram {
+   public:
+    Histogram();
+
+    void Add(base::TimeDelta value);
+    void Merge(const Histogram& other);
+
+    int64_t count() const { return count_; }
+
+    // Returns the upper bound of the bucket holding the |fraction| quantile,
+    // 0.5 for the median, and zero when empty.
+    base::TimeDelta Percentile(double fraction) const;
+
+   private:
+    // Durations up to 2^24 ms, longer ones land in the last bucket.
+    static const size_t kBucketCount = 176;
+
+    static size_t BucketIndex(int64_t milliseconds);
+    static int64_t BucketUpperBound(size_t index);
+
+    std::array<int64_t, kBucketCount> counts_;
+    int64_t count_;
+  };
+
+  using Histograms = std::array<Histogram, PHASE_COUNT>;
+
+  RequestLatencyTracker();
+
+  // Called on the IO thread once |request| completes. Only the successful
+  // requests are recorded, and only the phases they went through.
+  void RecordRequest(const net::URLRequest& request);
+
+  // Called on the UI thread. The requests since the partition was created, up
+  // to the last merge.
+  const Histogram& histogram(Phase phase) const { return histograms_[phase]; }
+
+ private:
+  friend struct content::BrowserThread::DeleteOnThread<
+      content::BrowserThread::IO>;
+  friend class base::DeleteHelper<RequestLatencyTracker>;
+
+  ~RequestLatencyTracker();
+
+  void FlushOnIOThread();
+  void MergeOnUIThread(std::unique_ptr<Histograms> pending);
+
+  // Only used on the IO thread.
+  std::unique_ptr<Histograms> pending_;
+  bool flush_scheduled_;
+
+  // Only used on the UI thread.
+  Histograms histograms_;
+
+  DISALLOW_COPY_AND_ASSIGN(RequestLatencyTracker);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_REQUEST_LATENCY_TRACKER_H_
@@ -0,0 +1,83 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/request_latency_tracker.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace brightray {
+
+namespace {
+
+using Histogram = RequestLatencyTracker::Histogram;
+
+base::TimeDelta Milliseconds(int64_t ms) {
+  return base::TimeDelta::FromMilliseconds(ms);
+}
+
+// The value reported for a single sample, the upper bound of its bucket.
+base::TimeDelta Bucket(int64_t ms) {
+  Histogram histogram;
+  histogram.Add(Milliseconds(ms));
+  return histogram.Percentile(0.5);
+}
+
+}  // namespace
+
+TEST(RequestLatencyTrackerTest, Buckets) {
+  // Small values get a bucket each.
+  for (int64_t ms = 0; ms < 10; ++ms)
+    EXPECT_EQ(Milliseconds(ms), Bucket(ms));
+
+  EXPECT_EQ(Milliseconds(103), Bucket(100));
+  EXPECT_EQ(Milliseconds(103), Bucket(103));
+  EXPECT_EQ(Milliseconds(111), Bucket(104));
+  EXPECT_EQ(Milliseconds(1023), Bucket(1000));
+
+  // Each bucket is within 12.5% of the values it holds.
+  for (int64_t ms = 1; ms < 100000; ms = ms * 3 / 2 + 1) {
+    base::TimeDelta bucket = Bucket(ms);
+    EXPECT_GE(bucket, Milliseconds(ms));
+    EXPECT_LE(bucket.InMilliseconds() * 8, ms * 9) << ms;
+  }
+
+  // Negative and huge durations are clamped.
+  EXPECT_EQ(Milliseconds(0), Bucket(-5));
+  EXPECT_EQ(Milliseconds((1 << 24) - 1), Bucket(int64_t(1) << 40));
+}
+
+TEST(RequestLatencyTrackerTest, Percentile) {
+  Histogram histogram;
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(base::TimeDelta(), histogram.Percentile(0.5));
+
+  for (int i = 0; i < 90; ++i)
+    histogram.Add(Milliseconds(5));
+  for (int i = 0; i < 10; ++i)
+    histogram.Add(Milliseconds(1000));
+  EXPECT_EQ(100, histogram.count());
+
+  EXPECT_EQ(Milliseconds(5), histogram.Percentile(0));
+  EXPECT_EQ(Milliseconds(5), histogram.Percentile(0.5));
+  EXPECT_EQ(Milliseconds(5), histogram.Percentile(0.9));
+  EXPECT_EQ(Milliseconds(1023), histogram.Percentile(0.91));
+  EXPECT_EQ(Milliseconds(1023), histogram.Percentile(1));
+  EXPECT_EQ(Milliseconds(1023), histogram.Percentile(2));
+}
+
+TEST(RequestLatencyTrackerTest, Merge) {
+  Histogram fast;
+  Histogram slow;
+  fast.Add(Milliseconds(1));
+  slow.Add(Milliseconds(7));
+  slow.Add(Milliseconds(7));
+
+  fast.Merge(slow);
+  EXPECT_EQ(3, fast.count());
+  EXPECT_EQ(Milliseconds(1), fast.Percentile(0.3));
+  EXPECT_EQ(Milliseconds(7), fast.Percentile(0.5));
+  EXPECT_EQ(2, slow.count());
+}
+
+}  // namespace brightray
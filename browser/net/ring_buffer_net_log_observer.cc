@@ -0,0 +1,143 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#include "browser/net/ring_buffer_net_log_observer.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/json/json_writer.h"
+#include "base/task_runner_util.h"
+#include "base/values.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/log/net_log_capture_mode.h"
+#include "net/log/net_log_entry.h"
+
+namespace brightray {
+
+namespace {
+
+// Roughly the size of |value| in JSON, without escaping or formatting the
+// numbers.
+size_t EstimateSize(const base::Value& value) {
+  const base::StringValue* string = nullptr;
+  if (value.GetAsString(&string))
+    return string->GetString().size() + 2;
+
+  const base::ListValue* list = nullptr;
+  if (value.GetAsList(&list)) {
+    size_t size = 2;
+    for (const auto& item : *list)
+      size += EstimateSize(*item) + 1;
+    return size;
+  }
+
+  const base::DictionaryValue* dict = nullptr;
+  if (value.GetAsDictionary(&dict)) {
+    size_t size = 2;
+    for (base::DictionaryValue::Iterator it(*dict); !it.IsAtEnd();
+         it.Advance()) {
+      size += it.key().size() + EstimateSize(it.value()) + 4;
+    }
+    return size;
+  }
+
+  // Booleans, numbers and null.
+  return 8;
+}
+
+}  // namespace
+
+RingBufferNetLogObserver::Event::Event(base::TimeTicks time,
+                                       std::unique_ptr<base::Value> value)
+    : time(time),
+      value(std::move(value)),
+      size(EstimateSize(*this->value)) {
+}
+
+RingBufferNetLogObserver::Event::~Event() {
+}
+
+// static
+bool RingBufferNetLogObserver::WriteEvents(
+    const base::FilePath& path,
+    const std::string& constants,
+    const std::vector<scoped_refptr<Event>>& events) {
+  std::string log = "{\"constants\": " + constants + ",\n\"events\": [\n";
+  std::string json;
+  for (size_t i = 0; i < events.size(); ++i) {
+    base::JSONWriter::Write(*events[i]->value, &json);
+    log += json;
+    log += i + 1 < events.size() ? ",\n" : "\n";
+  }
+  log += "]}\n";
+  return base::WriteFile(path, log.data(), log.size()) ==
+         static_cast<int>(log.size());
+}
+
+RingBufferNetLogObserver::RingBufferNetLogObserver(size_t max_bytes,
+                                                   base::TimeDelta max_age)
+    : max_bytes_(max_bytes),
+      max_age_(max_age),
+      size_(0) {
+}
+
+RingBufferNetLogObserver::~RingBufferNetLogObserver() {
+  DCHECK(!net_log());
+}
+
+void RingBufferNetLogObserver::StartObserving(net::NetLog* net_log) {
+  net_log->DeprecatedAddObserver(this, net::NetLogCaptureMode::Default());
+}
+
+void RingBufferNetLogObserver::StopObserving() {
+  if (net_log())
+    net_log()->DeprecatedRemoveObserver(this);
+}
+
+void RingBufferNetLogObserver::Dump(
+    const base::FilePath& path,
+    const base::Value& constants,
+    const base::Callback<void(bool)>& callback) {
+  std::vector<scoped_refptr<Event>> events;
+  {
+    base::AutoLock auto_lock(lock_);
+    PruneEvents(base::TimeTicks::Now());
+    events.assign(events_.begin(), events_.end());
+  }
+
+  std::string constants_json;
+  base::JSONWriter::Write(constants, &constants_json);
+  base::PostTaskAndReplyWithResult(
+      content::BrowserThread::GetBlockingPool(), FROM_HERE,
+      base::Bind(&RingBufferNetLogObserver::WriteEvents, path, constants_json,
+                 base::Passed(&events)),
+      callback);
+}
+
+void RingBufferNetLogObserver::OnAddEntry(const net::NetLogEntry& entry) {
+  // Called with the lock of the NetLog held. The parameters of |entry| can
+  // only be read now, but the JSON is only written when the events are
+  // dumped.
+  base::TimeTicks now = base::TimeTicks::Now();
+  scoped_refptr<Event> event(new Event(now, entry.ToValue()));
+
+  base::AutoLock auto_lock(lock_);
+  size_ += event->size;
+  events_.push_back(std::move(event));
+  PruneEvents(now);
+}
+
+void RingBufferNetLogObserver::PruneEvents(base::TimeTicks now) {
+  lock_.AssertAcquired();
+  while (!events_.empty() &&
+         (size_ > max_bytes_ || now - events_.front()->time > max_age_)) {
+    size_ -= events_.front()->size;
+    events_.pop_front();
+  }
+}
+
+}  // namespace brightray
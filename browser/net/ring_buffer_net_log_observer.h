@@ -0,0 +1,87 @@
+// Copyright (c) 2017 GitHub, Inc.
+// Use of this source code is governed by the MIT license that can be
+// found in the LICENSE file.
+
+#ifndef BROWSER_RING_BUFFER_NET_LOG_OBSERVER_H_
+#define BROWSER_RING_BUFFER_NET_LOG_OBSERVER_H_
+
+#include <stddef.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback_forward.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "net/log/net_log.h"
+
+namespace base {
+class FilePath;
+class Value;
+}
+
+namespace brightray {
+
+// Keeps the last events of a NetLog in memory, up to |max_bytes| of them and
+// none older than |max_age|, so that they can be written to a file once a
+// problem shows up. Events are captured without cookies or bytes, and only
+// serialized when they are dumped.
+class RingBufferNetLogObserver : public net::NetLog::ThreadSafeObserver {
+ public:
+  RingBufferNetLogObserver(size_t max_bytes, base::TimeDelta max_age);
+  ~RingBufferNetLogObserver() override;
+
+  void StartObserving(net::NetLog* net_log);
+  void StopObserving();
+
+  // Writes the buffered events to |path| on the blocking pool, in the format
+  // of --log-net-log, and calls |callback| with the result on the calling
+  // thread.
+  void Dump(const base::FilePath& path,
+            const base::Value& constants,
+            const base::Callback<void(bool)>& callback);
+
+  // net::NetLog::ThreadSafeObserver:
+  void OnAddEntry(const net::NetLogEntry& entry) override;
+
+ private:
+  // Shared with the dumps in progress, never modified once added.
+  struct Event : public base::RefCountedThreadSafe<Event> {
+    Event(base::TimeTicks time, std::unique_ptr<base::Value> value);
+
+    const base::TimeTicks time;
+    const std::unique_ptr<base::Value> value;
+    // Estimated size of |value| once serialized.
+    const size_t size;
+
+   private:
+    friend class base::RefCountedThreadSafe<Event>;
+    ~Event();
+  };
+
+  // Called on the blocking pool.
+  static bool WriteEvents(const base::FilePath& path,
+                          const std::string& constants,
+                          const std::vector<scoped_refptr<Event>>& events);
+
+  // Called with |lock_| held.
+  void PruneEvents(base::TimeTicks now);
+
+  const size_t max_bytes_;
+  const base::TimeDelta max_age_;
+
+  base::Lock lock_;
+  // Guarded by |lock_|, oldest first.
+  std::deque<scoped_refptr<Event>> events_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(RingBufferNetLogObserver);
+};
+
+}  // namespace brightray
+
+#endif  // BROWSER_RING_BUFFER_NET_LOG_OBSERVER_H_
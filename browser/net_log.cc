@@ -4,8 +4,12 @@
 
 #include "browser/net_log.h"
 
+#include "browser/net/ring_buffer_net_log_observer.h"
+#include "common/switches.h"
+
 #include "base/command_line.h"
 #include "base/files/file_path.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/values.h"
 #include "content/public/common/content_switches.h"
 #include "net/log/net_log_util.h"
@@ -14,6 +18,10 @@ namespace brightray {
 
 namespace {
 
+// Events older than this are dropped from the ring buffer unless
+// --net-log-ring-buffer-seconds says otherwise.
+const int kDefaultRingBufferSeconds = 5 * 60;
+
 std::unique_ptr<base::DictionaryValue> GetConstants() {
   std::unique_ptr<base::DictionaryValue> constants = net::GetNetConstants();
 
@@ -33,15 +41,31 @@ NetLog::NetLog() {
 }
 
 NetLog::~NetLog() {
+  if (ring_buffer_observer_)
+    ring_buffer_observer_->StopObserving();
 }
 
 void NetLog::StartLogging(net::URLRequestContext* url_request_context) {
   auto command_line = base::CommandLine::ForCurrentProcess();
-  if (!command_line->HasSwitch(switches::kLogNetLog))
+
+  // --net-log-ring-buffer-size
+  unsigned megabytes = 0;
+  if (base::StringToUint(command_line->GetSwitchValueASCII(
+          switches::kNetLogRingBufferSize), &megabytes) && megabytes > 0) {
+    int seconds = kDefaultRingBufferSeconds;
+    if (command_line->HasSwitch(switches::kNetLogRingBufferSeconds)) {
+      base::StringToInt(command_line->GetSwitchValueASCII(
+          switches::kNetLogRingBufferSeconds), &seconds);
+    }
+    StartRingBuffer(static_cast<size_t>(megabytes) * 1024 * 1024,
+                    base::TimeDelta::FromSeconds(seconds));
+  }
+
+  if (!command_line->HasSwitch(::switches::kLogNetLog))
     return;
 
   base::FilePath log_path =
-      command_line->GetSwitchValuePath(switches::kLogNetLog);
+      command_line->GetSwitchValuePath(::switches::kLogNetLog);
 #if defined(OS_WIN)
   log_file_.reset(_wfopen(log_path.value().c_str(), L"w"));
 #elif defined(OS_POSIX)
@@ -61,4 +85,22 @@ void NetLog::StartLogging(net::URLRequestContext* url_request_context) {
                                          url_request_context);
 }
 
+void NetLog::StartRingBuffer(size_t max_bytes, base::TimeDelta max_age) {
+  base::AutoLock auto_lock(ring_buffer_lock_);
+  if (ring_buffer_observer_)
+    return;
+  ring_buffer_observer_.reset(
+      new RingBufferNetLogObserver(max_bytes, max_age));
+  ring_buffer_observer_->StartObserving(this);
+}
+
+bool NetLog::DumpRingBuffer(const base::FilePath& path,
+                            const base::Callback<void(bool)>& callback) {
+  base::AutoLock auto_lock(ring_buffer_lock_);
+  if (!ring_buffer_observer_)
+    return false;
+  ring_buffer_observer_->Dump(path, *GetConstants(), callback);
+  return true;
+}
+
 }  // namespace brightray
@@ -5,12 +5,23 @@
 #ifndef BROWSER_NET_LOG_H_
 #define BROWSER_NET_LOG_H_
 
+#include <memory>
+
+#include "base/callback_forward.h"
 #include "base/files/scoped_file.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
 #include "net/log/net_log.h"
 #include "net/log/write_to_file_net_log_observer.h"
 
+namespace base {
+class FilePath;
+}
+
 namespace brightray {
 
+class RingBufferNetLogObserver;
+
 class NetLog : public net::NetLog {
  public:
   NetLog();
@@ -18,9 +29,24 @@ class NetLog : public net::NetLog {
 
   void StartLogging(net::URLRequestContext* url_request_context);
 
+  // Keeps the last events in memory, up to |max_bytes| of them and none
+  // older than |max_age|. Does nothing when already started. Can be called on
+  // any thread, as DumpRingBuffer().
+  void StartRingBuffer(size_t max_bytes, base::TimeDelta max_age);
+
+  // Writes the events kept in memory to |path| and calls |callback| with the
+  // result on the calling thread. Returns false when the ring buffer has not
+  // been started.
+  bool DumpRingBuffer(const base::FilePath& path,
+                      const base::Callback<void(bool)>& callback);
+
  private:
   base::ScopedFILE log_file_;
   net::WriteToFileNetLogObserver write_to_file_observer_;
+  // Started on the IO thread by StartLogging() or by the embedder on any
+  // thread.
+  base::Lock ring_buffer_lock_;
+  std::unique_ptr<RingBufferNetLogObserver> ring_buffer_observer_;
 
   DISALLOW_COPY_AND_ASSIGN(NetLog);
 };
@@ -5,10 +5,16 @@
 #include "browser/network_delegate.h"
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/command_line.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
+#include "browser/net/devtools_network_transaction.h"
+#include "browser/net/network_usage_tracker.h"
+#include "browser/net/request_latency_tracker.h"
+#include "content/public/browser/resource_request_info.h"
 #include "net/base/load_flags.h"
 #include "net/base/net_errors.h"
 #include "net/url_request/url_request.h"
@@ -20,16 +26,25 @@ namespace {
 // Ignore the limit of 6 connections per host.
 const char kIgnoreConnectionsLimit[] = "ignore-connections-limit";
 
+std::vector<std::string> GetIgnoreConnectionsLimitDomains() {
+  std::string value = base::CommandLine::ForCurrentProcess()->
+      GetSwitchValueASCII(kIgnoreConnectionsLimit);
+  return base::SplitString(
+      value, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+}
+
 }  // namespace
 
-NetworkDelegate::NetworkDelegate() {
-  auto command_line = base::CommandLine::ForCurrentProcess();
-  if (command_line->HasSwitch(kIgnoreConnectionsLimit)) {
-    std::string value =
-        command_line->GetSwitchValueASCII(kIgnoreConnectionsLimit);
-    ignore_connections_limit_domains_ = base::SplitString(
-        value, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
-  }
+NetworkDelegate::NetworkDelegate()
+    : ignore_connections_limit_domains_(GetIgnoreConnectionsLimitDomains()) {
+}
+
+NetworkDelegate::NetworkDelegate(
+    scoped_refptr<NetworkUsageTracker> usage_tracker,
+    scoped_refptr<RequestLatencyTracker> latency_tracker)
+    : ignore_connections_limit_domains_(GetIgnoreConnectionsLimitDomains()),
+      usage_tracker_(std::move(usage_tracker)),
+      latency_tracker_(std::move(latency_tracker)) {
 }
 
 NetworkDelegate::~NetworkDelegate() {
@@ -39,13 +54,21 @@ int NetworkDelegate::OnBeforeURLRequest(
     net::URLRequest* request,
     const net::CompletionCallback& callback,
     GURL* new_url) {
-  for (const auto& domain : ignore_connections_limit_domains_) {
-    if (request->url().DomainIs(domain)) {
-      // Allow unlimited concurrent connections.
-      request->SetPriority(net::MAXIMUM_PRIORITY);
-      request->SetLoadFlags(request->load_flags() | net::LOAD_IGNORE_LIMITS);
-      break;
-    }
+  if (ignore_connections_limit_domains_.Matches(request->url())) {
+    // Allow unlimited concurrent connections.
+    request->SetPriority(net::MAXIMUM_PRIORITY);
+    request->SetLoadFlags(request->load_flags() | net::LOAD_IGNORE_LIMITS);
+  }
+
+  // Let the DevTools network rules match on the resource type.
+  const content::ResourceRequestInfo* info =
+      content::ResourceRequestInfo::ForRequest(request);
+  if (info && request->extra_request_headers().HasHeader(
+      DevToolsNetworkTransaction::kDevToolsEmulateNetworkConditionsClientId)) {
+    request->SetExtraRequestHeaderByName(
+        DevToolsNetworkTransaction::kDevToolsResourceType,
+        base::IntToString(info->GetResourceType()),
+        true);
   }
 
   return net::OK;
@@ -88,13 +111,19 @@ void NetworkDelegate::OnResponseStarted(net::URLRequest* request) {
 
 void NetworkDelegate::OnNetworkBytesReceived(net::URLRequest* request,
                                              int64_t bytes_read) {
+  if (usage_tracker_)
+    usage_tracker_->RecordBytesReceived(request, bytes_read);
 }
 
 void NetworkDelegate::OnNetworkBytesSent(net::URLRequest* request,
                                          int64_t bytes_sent) {
+  if (usage_tracker_)
+    usage_tracker_->RecordBytesSent(request, bytes_sent);
 }
 
 void NetworkDelegate::OnCompleted(net::URLRequest* request, bool started) {
+  if (latency_tracker_ && started)
+    latency_tracker_->RecordRequest(*request);
 }
 
 void NetworkDelegate::OnURLRequestDestroyed(net::URLRequest* request) {
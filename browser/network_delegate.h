@@ -5,17 +5,23 @@
 #ifndef BRIGHTRAY_BROWSER_NETWORK_DELEGATE_H_
 #define BRIGHTRAY_BROWSER_NETWORK_DELEGATE_H_
 
-#include <string>
-#include <vector>
-
+#include "base/memory/ref_counted.h"
+#include "browser/net/domain_matcher.h"
 #include "net/base/network_delegate.h"
 #include "net/proxy/proxy_server.h"
 
 namespace brightray {
 
+class NetworkUsageTracker;
+class RequestLatencyTracker;
+
 class NetworkDelegate : public net::NetworkDelegate {
  public:
   NetworkDelegate();
+  // Counts the bytes of the requests in |usage_tracker| and the duration of
+  // their phases in |latency_tracker|, either can be null.
+  NetworkDelegate(scoped_refptr<NetworkUsageTracker> usage_tracker,
+                  scoped_refptr<RequestLatencyTracker> latency_tracker);
   virtual ~NetworkDelegate();
 
  protected:
@@ -70,7 +76,9 @@ class NetworkDelegate : public net::NetworkDelegate {
       const GURL& referrer_url) const override;
 
  private:
-  std::vector<std::string> ignore_connections_limit_domains_;
+  const DomainMatcher ignore_connections_limit_domains_;
+  scoped_refptr<NetworkUsageTracker> usage_tracker_;
+  scoped_refptr<RequestLatencyTracker> latency_tracker_;
 
   DISALLOW_COPY_AND_ASSIGN(NetworkDelegate);
 };
@@ -8,30 +8,41 @@
 
 #include "browser/net/devtools_network_controller_handle.h"
 #include "browser/net/devtools_network_transaction_factory.h"
+#include "browser/net/host_cache_persister.h"
+#include "browser/net/http_transaction_counter.h"
+#include "browser/net/preconnect_manager.h"
 #include "browser/net_log.h"
 #include "browser/network_delegate.h"
 #include "common/switches.h"
 
 #include "base/command_line.h"
+#include "base/lazy_instance.h"
 #include "base/memory/ptr_util.h"
+#include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "base/threading/sequenced_worker_pool.h"
 #include "base/threading/worker_pool.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/cookie_store_factory.h"
 #include "content/public/common/content_switches.h"
+#include "net/base/address_list.h"
 #include "net/base/host_mapping_rules.h"
+#include "net/base/host_port_pair.h"
+#include "net/base/net_errors.h"
 #include "net/cert/cert_verifier.h"
 #include "net/cert/ct_known_logs.h"
 #include "net/cert/ct_log_verifier.h"
 #include "net/cert/ct_policy_enforcer.h"
 #include "net/cert/multi_log_ct_verifier.h"
 #include "net/cookies/cookie_monster.h"
+#include "net/dns/host_resolver.h"
 #include "net/dns/mapped_host_resolver.h"
 #include "net/http/http_auth_filter.h"
 #include "net/http/http_auth_handler_factory.h"
 #include "net/http/http_auth_preferences.h"
+#include "net/http/http_network_layer.h"
 #include "net/http/http_server_properties_impl.h"
+#include "net/http/http_server_properties_manager.h"
 #include "net/log/net_log.h"
 #include "net/proxy/dhcp_proxy_script_fetcher_factory.h"
 #include "net/proxy/proxy_config.h"
@@ -39,6 +50,7 @@
 #include "net/proxy/proxy_script_fetcher_impl.h"
 #include "net/proxy/proxy_service.h"
 #include "net/proxy/proxy_service_v8.h"
+#include "net/quic/core/quic_protocol.h"
 #include "net/ssl/channel_id_service.h"
 #include "net/ssl/default_channel_id_store.h"
 #include "net/ssl/ssl_config_service_defaults.h"
@@ -62,6 +74,170 @@ using content::BrowserThread;
 
 namespace brightray {
 
+namespace {
+
+// Returns QUIC_VERSION_UNSUPPORTED for unknown versions.
+net::QuicVersion ParseQuicVersion(const std::string& name) {
+  for (net::QuicVersion version : net::AllSupportedVersions()) {
+    if (net::QuicVersionToString(version) == name)
+      return version;
+  }
+  return net::QUIC_VERSION_UNSUPPORTED;
+}
+
+// Tags are made of up to four characters, shorter ones are padded with 0.
+bool ParseQuicConnectionOptions(const std::string& options,
+                                net::QuicTagVector* tags) {
+  for (const std::string& option : base::SplitString(
+           options, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    if (option.size() > 4)
+      return false;
+    char tag[4] = { 0, 0, 0, 0 };
+    option.copy(tag, option.size());
+    tags->push_back(net::MakeQuicTag(tag[0], tag[1], tag[2], tag[3]));
+  }
+  return true;
+}
+
+void ConfigureQuic(const URLRequestContextGetter::QuicOptions& options,
+                   const std::string& user_agent,
+                   net::HttpNetworkSession::Params* params) {
+  params->enable_quic =
+      options.enabled || !options.origins_to_force_quic_on.empty();
+  if (!params->enable_quic)
+    return;
+
+  params->quic_user_agent_id = user_agent;
+  if (!options.version.empty()) {
+    net::QuicVersion version = ParseQuicVersion(options.version);
+    if (version != net::QUIC_VERSION_UNSUPPORTED)
+      params->quic_supported_versions = net::QuicVersionVector(1, version);
+    else
+      LOG(ERROR) << "Unsupported QUIC version: " << options.version;
+  }
+  if (!ParseQuicConnectionOptions(options.connection_options,
+                                  &params->quic_connection_options)) {
+    LOG(ERROR) << "Invalid QUIC connection options: "
+               << options.connection_options;
+    params->quic_connection_options.clear();
+  }
+  for (const std::string& origin : options.origins_to_force_quic_on) {
+    net::HostPortPair host_port = net::HostPortPair::FromString(origin);
+    if (host_port.IsEmpty())
+      LOG(ERROR) << "Invalid origin to force QUIC on: " << origin;
+    else
+      params->origins_to_force_quic_on.insert(host_port);
+  }
+}
+
+using CTLogVerifiers = std::vector<scoped_refptr<const net::CTLogVerifier>>;
+
+// The known CT logs are parsed once for all the partitions.
+struct SharedCTLogs {
+  // Only used on the UI thread.
+  bool parsing_started = false;
+
+  // Only used on the IO thread.
+  std::unique_ptr<CTLogVerifiers> verifiers;
+  // Getters waiting for |verifiers| to create their context.
+  std::vector<scoped_refptr<URLRequestContextGetter>> waiting_getters;
+};
+
+base::LazyInstance<SharedCTLogs>::Leaky g_ct_logs = LAZY_INSTANCE_INITIALIZER;
+
+// Returns the known CT logs, parsing them now if the worker thread has not
+// finished yet.
+const CTLogVerifiers& GetCTLogVerifiers() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  SharedCTLogs& ct_logs = g_ct_logs.Get();
+  if (!ct_logs.verifiers) {
+    ct_logs.verifiers.reset(
+        new CTLogVerifiers(net::ct::CreateLogVerifiersForKnownLogs()));
+  }
+  return *ct_logs.verifiers;
+}
+
+void OnCTLogVerifiersCreated(const CTLogVerifiers& verifiers) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  SharedCTLogs& ct_logs = g_ct_logs.Get();
+  // A context may have parsed them by itself in the meantime.
+  if (!ct_logs.verifiers)
+    ct_logs.verifiers.reset(new CTLogVerifiers(verifiers));
+
+  std::vector<scoped_refptr<URLRequestContextGetter>> getters;
+  getters.swap(ct_logs.waiting_getters);
+  for (const auto& getter : getters)
+    getter->GetURLRequestContext();
+}
+
+// Parses the keys of the known CT logs, which takes a while, and replies on
+// |reply_task_runner|.
+void CreateCTLogVerifiers(
+    scoped_refptr<base::SingleThreadTaskRunner> reply_task_runner) {
+  reply_task_runner->PostTask(
+      FROM_HERE, base::Bind(&OnCTLogVerifiersCreated,
+                            net::ct::CreateLogVerifiersForKnownLogs()));
+}
+
+}  // namespace
+
+// Resolves a host at idle priority, leaving the addresses in the host cache.
+// Owned by the getter, which cancels the requests still pending when it is
+// destroyed.
+class URLRequestContextGetter::PrefetchRequest {
+ public:
+  PrefetchRequest() {}
+
+  // Returns false when the host was resolved synchronously.
+  bool Start(net::HostResolver* resolver,
+             const std::string& host,
+             const net::CompletionCallback& callback) {
+    // The port is not part of the host cache key.
+    net::HostResolver::RequestInfo info(net::HostPortPair(host, 80));
+    info.set_is_speculative(true);
+    return resolver->Resolve(info, net::IDLE, &addresses_, callback,
+                             &request_, net::NetLogWithSource()) ==
+        net::ERR_IO_PENDING;
+  }
+
+ private:
+  net::AddressList addresses_;
+  std::unique_ptr<net::HostResolver::Request> request_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrefetchRequest);
+};
+
+URLRequestContextGetter::HttpCacheOptions::HttpCacheOptions()
+    : max_size(0),
+      backend_type(net::CACHE_BACKEND_DEFAULT) {
+}
+
+URLRequestContextGetter::QuicOptions::QuicOptions()
+    : enabled(false) {
+}
+
+URLRequestContextGetter::QuicOptions::QuicOptions(
+    const QuicOptions& other) = default;
+
+URLRequestContextGetter::QuicOptions::~QuicOptions() {
+}
+
+URLRequestContextGetter::SharedNetworkSession::SharedNetworkSession()
+    : share_socket_pools(false) {
+}
+
+URLRequestContextGetter::SharedNetworkSession::SharedNetworkSession(
+    const SharedNetworkSession& other) = default;
+
+URLRequestContextGetter::SharedNetworkSession::~SharedNetworkSession() {
+}
+
+URLRequestContextGetter::HttpCacheStats::HttpCacheStats()
+    : requests(0),
+      hits(0),
+      misses(0) {
+}
+
 std::string URLRequestContextGetter::Delegate::GetUserAgent() {
   return base::EmptyString();
 }
@@ -89,15 +265,55 @@ URLRequestContextGetter::Delegate::CreateURLRequestJobFactory(
   return std::move(job_factory);
 }
 
+URLRequestContextGetter::HttpCacheOptions
+URLRequestContextGetter::Delegate::GetHttpCacheOptions() {
+  return HttpCacheOptions();
+}
+
+URLRequestContextGetter::QuicOptions
+URLRequestContextGetter::Delegate::GetQuicOptions() {
+  auto command_line = base::CommandLine::ForCurrentProcess();
+  QuicOptions options;
+  options.enabled = command_line->HasSwitch(switches::kEnableQuic);
+  options.version = command_line->GetSwitchValueASCII(switches::kQuicVersion);
+  options.connection_options =
+      command_line->GetSwitchValueASCII(switches::kQuicConnectionOptions);
+  options.origins_to_force_quic_on = base::SplitString(
+      command_line->GetSwitchValueASCII(switches::kOriginToForceQuicOn), ",",
+      base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  return options;
+}
+
+std::unique_ptr<net::HttpServerPropertiesManager>
+URLRequestContextGetter::Delegate::CreateHttpServerPropertiesManager() {
+  return nullptr;
+}
+
+std::unique_ptr<HostCachePersister>
+URLRequestContextGetter::Delegate::CreateHostCachePersister() {
+  return nullptr;
+}
+
+URLRequestContextGetter::SharedNetworkSession
+URLRequestContextGetter::Delegate::GetSharedNetworkSession() {
+  return SharedNetworkSession();
+}
+
+std::unique_ptr<PreconnectManager>
+URLRequestContextGetter::Delegate::CreatePreconnectManager() {
+  return base::MakeUnique<PreconnectManager>(nullptr, 0);
+}
+
 net::HttpCache::BackendFactory*
 URLRequestContextGetter::Delegate::CreateHttpCacheBackendFactory(
     const base::FilePath& base_path) {
+  HttpCacheOptions options = GetHttpCacheOptions();
   base::FilePath cache_path = base_path.Append(FILE_PATH_LITERAL("Cache"));
   return new net::HttpCache::DefaultBackend(
       net::DISK_CACHE,
-      net::CACHE_BACKEND_DEFAULT,
+      options.backend_type,
       cache_path,
-      0,
+      options.max_size,
       BrowserThread::GetTaskRunnerForThread(BrowserThread::CACHE));
 }
 
@@ -134,15 +350,27 @@ URLRequestContextGetter::URLRequestContextGetter(
       io_task_runner_(io_task_runner),
       file_task_runner_(file_task_runner),
       protocol_interceptors_(std::move(protocol_interceptors)),
-      job_factory_(nullptr) {
+      job_factory_(nullptr),
+      cache_backend_(nullptr),
+      created_time_(base::TimeTicks::Now()),
+      request_counter_(nullptr),
+      network_counter_(nullptr) {
   // Must first be created on the UI thread.
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
 
   if (protocol_handlers)
     std::swap(protocol_handlers_, *protocol_handlers);
 
-  if (delegate_)
+  if (delegate_) {
     user_agent_ = delegate_->GetUserAgent();
+    http_server_properties_manager_ =
+        delegate_->CreateHttpServerPropertiesManager();
+    preconnect_manager_ = delegate_->CreatePreconnectManager();
+    shared_session_ = delegate_->GetSharedNetworkSession();
+    // The host cache belongs to the owner of a shared resolver.
+    if (!shared_session_.owner)
+      host_cache_persister_ = delegate_->CreateHostCachePersister();
+  }
 
   // We must create the proxy config service on the UI loop on Linux because it
   // must synchronously run on the glib message loop. This will be passed to
@@ -161,6 +389,29 @@ net::HostResolver* URLRequestContextGetter::host_resolver() {
   return url_request_context_->host_resolver();
 }
 
+void URLRequestContextGetter::StartParsingCTLogs() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  SharedCTLogs& ct_logs = g_ct_logs.Get();
+  if (!ct_logs.parsing_started) {
+    ct_logs.parsing_started = true;
+    BrowserThread::PostBlockingPoolTask(
+        FROM_HERE, base::Bind(&CreateCTLogVerifiers, io_task_runner_));
+  }
+  io_task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&URLRequestContextGetter::CreateContextOnceCTLogsParsed,
+                 this));
+}
+
+void URLRequestContextGetter::CreateContextOnceCTLogsParsed() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  SharedCTLogs& ct_logs = g_ct_logs.Get();
+  if (ct_logs.verifiers)
+    GetURLRequestContext();
+  else
+    ct_logs.waiting_getters.push_back(this);
+}
+
 net::URLRequestContext* URLRequestContextGetter::GetURLRequestContext() {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
 
@@ -179,6 +430,10 @@ net::URLRequestContext* URLRequestContextGetter::GetURLRequestContext() {
     }
 
     network_delegate_.reset(delegate_->CreateNetworkDelegate());
+    if (preconnect_manager_) {
+      network_delegate_ = preconnect_manager_->WrapNetworkDelegate(
+          std::move(network_delegate_));
+    }
     url_request_context_->set_network_delegate(network_delegate_.get());
 
     storage_.reset(
@@ -194,6 +449,10 @@ net::URLRequestContext* URLRequestContextGetter::GetURLRequestContext() {
     cookie_config.cookieable_schemes = delegate_->GetCookieableSchemes();
     std::unique_ptr<net::CookieStore> cookie_store =
         content::CreateCookieStore(cookie_config);
+    // Starts loading the cookie database in the background now instead of
+    // on the first request which needs it.
+    cookie_store->GetAllCookiesAsync(base::Bind(
+        &URLRequestContextGetter::OnCookiesLoaded, base::Unretained(this)));
     storage_->set_cookie_store(std::move(cookie_store));
     storage_->set_channel_id_service(base::MakeUnique<net::ChannelIDService>(
         new net::DefaultChannelIDStore(nullptr)));
@@ -204,11 +463,21 @@ net::URLRequestContext* URLRequestContextGetter::GetURLRequestContext() {
             net::HttpUtil::GenerateAcceptLanguageHeader(accept_lang),
             user_agent_)));
 
-    std::unique_ptr<net::HostResolver> host_resolver(
-        net::HostResolver::CreateDefaultResolver(nullptr));
+    // The partition sharing its network session with this one.
+    net::URLRequestContext* owner_context =
+        shared_session_.owner ? shared_session_.owner->GetURLRequestContext()
+                              : nullptr;
+
+    std::unique_ptr<net::HostResolver> host_resolver;
+    if (owner_context) {
+      url_request_context_->set_host_resolver(owner_context->host_resolver());
+    } else {
+      host_resolver = net::HostResolver::CreateDefaultResolver(nullptr);
+    }
 
     // --host-resolver-rules
-    if (command_line.HasSwitch(::switches::kHostResolverRules)) {
+    if (host_resolver &&
+        command_line.HasSwitch(::switches::kHostResolverRules)) {
       std::unique_ptr<net::MappedHostResolver> remapped_resolver(
           new net::MappedHostResolver(std::move(host_resolver)));
       remapped_resolver->SetRulesFromString(
@@ -216,6 +485,9 @@ net::URLRequestContext* URLRequestContextGetter::GetURLRequestContext() {
       host_resolver = std::move(remapped_resolver);
     }
 
+    net::HostResolver* resolver =
+        owner_context ? owner_context->host_resolver() : host_resolver.get();
+
     // --proxy-server
     net::DhcpProxyScriptFetcherFactory dhcp_factory;
     if (command_line.HasSwitch(switches::kNoProxyServer)) {
@@ -239,7 +511,7 @@ net::URLRequestContext* URLRequestContextGetter::GetURLRequestContext() {
               std::move(proxy_config_service_),
               new net::ProxyScriptFetcherImpl(url_request_context_.get()),
               dhcp_factory.Create(url_request_context_.get()),
-              host_resolver.get(),
+              resolver,
               nullptr,
               url_request_context_->network_delegate()));
     }
@@ -271,23 +543,33 @@ net::URLRequestContext* URLRequestContextGetter::GetURLRequestContext() {
 
     auto auth_handler_factory =
         net::HttpAuthHandlerRegistryFactory::Create(
-            http_auth_preferences_.get(), host_resolver.get());
+            http_auth_preferences_.get(), resolver);
 
     std::unique_ptr<net::TransportSecurityState> transport_security_state =
         base::WrapUnique(new net::TransportSecurityState);
     transport_security_state->SetRequireCTDelegate(
         delegate_->GetRequireCTDelegate());
     storage_->set_transport_security_state(std::move(transport_security_state));
-    storage_->set_cert_verifier(delegate_->CreateCertVerifier());
+    if (owner_context)
+      url_request_context_->set_cert_verifier(owner_context->cert_verifier());
+    else
+      storage_->set_cert_verifier(delegate_->CreateCertVerifier());
     storage_->set_ssl_config_service(delegate_->CreateSSLConfigService());
     storage_->set_http_auth_handler_factory(std::move(auth_handler_factory));
-    std::unique_ptr<net::HttpServerProperties> server_properties(
-        new net::HttpServerPropertiesImpl);
+    // The manager loads what was learned by the previous runs and writes
+    // the changes back in batches.
+    std::unique_ptr<net::HttpServerProperties> server_properties;
+    if (http_server_properties_manager_) {
+      http_server_properties_manager_->InitializeOnNetworkThread();
+      server_properties = std::move(http_server_properties_manager_);
+    } else {
+      server_properties.reset(new net::HttpServerPropertiesImpl);
+    }
     storage_->set_http_server_properties(std::move(server_properties));
 
     std::unique_ptr<net::MultiLogCTVerifier> ct_verifier =
         base::MakeUnique<net::MultiLogCTVerifier>();
-    ct_verifier->AddLogs(net::ct::CreateLogVerifiersForKnownLogs());
+    ct_verifier->AddLogs(GetCTLogVerifiers());
     storage_->set_cert_transparency_verifier(std::move(ct_verifier));
     storage_->set_ct_policy_enforcer(base::MakeUnique<net::CTPolicyEnforcer>());
 
@@ -304,6 +586,11 @@ net::URLRequestContext* URLRequestContextGetter::GetURLRequestContext() {
     if (command_line.HasSwitch(switches::kIgnoreCertificateErrors))
       network_session_params.ignore_certificate_errors = true;
 
+    // --enable-quic, the alternative services servers advertise are kept by
+    // the server properties.
+    ConfigureQuic(delegate_->GetQuicOptions(), user_agent_,
+                  &network_session_params);
+
     // --host-rules
     if (command_line.HasSwitch(switches::kHostRules)) {
       host_mapping_rules_.reset(new net::HostMappingRules);
@@ -313,33 +600,55 @@ net::URLRequestContext* URLRequestContextGetter::GetURLRequestContext() {
     }
 
     // Give |storage_| ownership at the end in case it's |mapped_host_resolver|.
-    storage_->set_host_resolver(std::move(host_resolver));
+    if (host_resolver)
+      storage_->set_host_resolver(std::move(host_resolver));
     network_session_params.host_resolver =
         url_request_context_->host_resolver();
+    if (host_cache_persister_) {
+      host_cache_persister_->InitializeOnIOThread(
+          url_request_context_->host_resolver()->GetHostCache());
+    }
 
-    http_network_session_.reset(
-        new net::HttpNetworkSession(network_session_params));
+    // Sharing the session shares its socket pools, SSL session cache and
+    // HTTP auth cache, and the components it was created with.
+    net::HttpNetworkSession* network_session = nullptr;
+    if (owner_context && shared_session_.share_socket_pools) {
+      network_session = owner_context->http_transaction_factory()->GetSession();
+    } else {
+      http_network_session_.reset(
+          new net::HttpNetworkSession(network_session_params));
+      network_session = http_network_session_.get();
+    }
+    HttpCacheOptions cache_options = delegate_->GetHttpCacheOptions();
     std::unique_ptr<net::HttpCache::BackendFactory> backend;
     if (in_memory_) {
-      backend = net::HttpCache::DefaultBackend::InMemory(0);
+      backend = net::HttpCache::DefaultBackend::InMemory(
+          cache_options.max_size);
     } else {
       backend.reset(delegate_->CreateHttpCacheBackendFactory(base_path_));
     }
 
+    std::unique_ptr<net::HttpTransactionFactory> network_layer;
     if (network_controller_handle_) {
-      storage_->set_http_transaction_factory(base::WrapUnique(
-          new net::HttpCache(
-              base::WrapUnique(new DevToolsNetworkTransactionFactory(
-                  network_controller_handle_->GetController(),
-                  http_network_session_.get())),
-              std::move(backend),
-              false)));
+      network_layer.reset(new DevToolsNetworkTransactionFactory(
+          network_controller_handle_->GetController(),
+          network_session));
     } else {
-      storage_->set_http_transaction_factory(base::WrapUnique(
-          new net::HttpCache(http_network_session_.get(),
-                             std::move(backend),
-                             false)));
+      network_layer.reset(new net::HttpNetworkLayer(network_session));
     }
+    network_counter_ = new HttpTransactionCounter(std::move(network_layer));
+    std::unique_ptr<net::HttpCache> http_cache(new net::HttpCache(
+        base::WrapUnique(network_counter_), std::move(backend), false));
+    // Opens the backend on the cache thread while the rest of the context is
+    // set up and the first request is prepared.
+    int rv = http_cache->GetBackend(
+        &cache_backend_,
+        base::Bind(&URLRequestContextGetter::OnCacheBackendReady,
+                   base::Unretained(this)));
+    if (rv != net::ERR_IO_PENDING)
+      OnCacheBackendReady(rv);
+    request_counter_ = new HttpTransactionCounter(std::move(http_cache));
+    storage_->set_http_transaction_factory(base::WrapUnique(request_counter_));
 
     std::unique_ptr<net::URLRequestJobFactory> job_factory =
         delegate_->CreateURLRequestJobFactory(&protocol_handlers_);
@@ -358,11 +667,88 @@ net::URLRequestContext* URLRequestContextGetter::GetURLRequestContext() {
     protocol_interceptors_.clear();
 
     storage_->set_job_factory(std::move(top_job_factory));
+
+    if (preconnect_manager_)
+      preconnect_manager_->InitializeOnIOThread(url_request_context_.get());
+
+    context_created_time_ = base::TimeTicks::Now();
   }
 
   return url_request_context_.get();
 }
 
+URLRequestContextGetter::HttpCacheStats
+URLRequestContextGetter::GetHttpCacheStats() const {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+
+  HttpCacheStats stats;
+  if (!request_counter_)
+    return stats;
+
+  stats.requests = request_counter_->count();
+  stats.misses = network_counter_->count();
+  stats.hits = stats.requests - stats.misses;
+  return stats;
+}
+
+URLRequestContextGetter::StartupTimings
+URLRequestContextGetter::GetStartupTimings() const {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+
+  auto since_created = [this](base::TimeTicks time) {
+    return time.is_null() ? base::TimeDelta() : time - created_time_;
+  };
+  StartupTimings timings;
+  timings.context_created = since_created(context_created_time_);
+  if (request_counter_) {
+    timings.first_request =
+        since_created(request_counter_->first_transaction_time());
+  }
+  timings.cache_backend_ready = since_created(cache_backend_ready_time_);
+  timings.cookies_loaded = since_created(cookies_loaded_time_);
+  return timings;
+}
+
+void URLRequestContextGetter::OnCacheBackendReady(int result) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  cache_backend_ready_time_ = base::TimeTicks::Now();
+}
+
+void URLRequestContextGetter::OnCookiesLoaded(const net::CookieList& cookies) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  cookies_loaded_time_ = base::TimeTicks::Now();
+}
+
+void URLRequestContextGetter::PrefetchDNS(
+    const std::vector<std::string>& hosts) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+
+  net::HostResolver* resolver = GetURLRequestContext()->host_resolver();
+  for (const auto& host : hosts) {
+    std::unique_ptr<PrefetchRequest> request(new PrefetchRequest);
+    PrefetchRequest* raw_request = request.get();
+    if (raw_request->Start(
+            resolver, host,
+            base::Bind(&URLRequestContextGetter::OnPrefetchDone,
+                       base::Unretained(this), raw_request))) {
+      prefetch_requests_[raw_request] = std::move(request);
+    }
+  }
+}
+
+void URLRequestContextGetter::OnPrefetchDone(PrefetchRequest* request,
+                                             int result) {
+  prefetch_requests_.erase(request);
+}
+
+void URLRequestContextGetter::Preconnect(const GURL& url, int num_sockets) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+
+  GetURLRequestContext();
+  if (preconnect_manager_)
+    preconnect_manager_->Preconnect(url, num_sockets);
+}
+
 scoped_refptr<base::SingleThreadTaskRunner>
 URLRequestContextGetter::GetNetworkTaskRunner() const {
   return BrowserThread::GetTaskRunnerForThread(BrowserThread::IO);
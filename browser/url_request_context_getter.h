@@ -5,23 +5,35 @@
 #ifndef BRIGHTRAY_BROWSER_URL_REQUEST_CONTEXT_GETTER_H_
 #define BRIGHTRAY_BROWSER_URL_REQUEST_CONTEXT_GETTER_H_
 
+#include <map>
+#include <memory>
+
 #include "base/files/file_path.h"
+#include "base/time/time.h"
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/content_browser_client.h"
+#include "net/base/cache_type.h"
 #include "net/cookies/cookie_monster.h"
 #include "net/http/http_cache.h"
 #include "net/http/transport_security_state.h"
 #include "net/http/url_security_manager.h"
 #include "net/url_request/url_request_context_getter.h"
 
+class GURL;
+
 namespace base {
 class MessageLoop;
 }
 
+namespace disk_cache {
+class Backend;
+}
+
 namespace net {
 class HostMappingRules;
 class HostResolver;
 class HttpAuthPreferences;
+class HttpServerPropertiesManager;
 class NetworkDelegate;
 class ProxyConfigService;
 class URLRequestContextStorage;
@@ -31,11 +43,80 @@ class URLRequestJobFactory;
 namespace brightray {
 
 class DevToolsNetworkControllerHandle;
+class HostCachePersister;
+class HttpTransactionCounter;
 class MediaDeviceIDSalt;
 class NetLog;
+class PreconnectManager;
 
 class URLRequestContextGetter : public net::URLRequestContextGetter {
  public:
+  // How the HTTP cache of a partition is built.
+  struct HttpCacheOptions {
+    HttpCacheOptions();
+
+    // Maximum size of the cache in bytes, 0 lets the backend pick one.
+    int max_size;
+    // Either the blockfile or the simple cache, CACHE_BACKEND_DEFAULT picks
+    // the one of the platform.
+    net::BackendType backend_type;
+  };
+
+  // Requests are the transactions started through the cache, and misses
+  // those which went to the network, including the revalidations.
+  struct HttpCacheStats {
+    HttpCacheStats();
+
+    int64_t requests;
+    int64_t hits;
+    int64_t misses;
+  };
+
+  struct QuicOptions {
+    QuicOptions();
+    QuicOptions(const QuicOptions& other);
+    ~QuicOptions();
+
+    bool enabled;
+    // Name of the QUIC version, empty picks the default one.
+    std::string version;
+    // Comma-separated list of QUIC tags.
+    std::string connection_options;
+    // host:port origins always reached over QUIC, even without Alt-Svc.
+    std::vector<std::string> origins_to_force_quic_on;
+  };
+
+  // Startup of the request context, measured from the creation of the
+  // getter. Steps which have not happened yet are zero.
+  struct StartupTimings {
+    // GetURLRequestContext() returned for the first time.
+    base::TimeDelta context_created;
+    // The first HTTP transaction was started.
+    base::TimeDelta first_request;
+    // The disk cache backend was opened.
+    base::TimeDelta cache_backend_ready;
+    // The persistent cookies were loaded.
+    base::TimeDelta cookies_loaded;
+  };
+
+  // Lets a partition use the network components of another one. Cookies and
+  // the HTTP cache stay separate.
+  struct SharedNetworkSession {
+    SharedNetworkSession();
+    SharedNetworkSession(const SharedNetworkSession& other);
+    ~SharedNetworkSession();
+
+    // Lends its host resolver, host cache included, and its certificate
+    // verifier, null shares nothing.
+    scoped_refptr<URLRequestContextGetter> owner;
+    // Also uses the network session of |owner|. Besides the socket pools and
+    // the SSL session cache, that shares the HTTP auth cache, the channel IDs
+    // and the server properties: credentials entered in one partition are
+    // sent by the other. The proxy, QUIC and security settings of |owner|
+    // then apply to the requests of this partition.
+    bool share_socket_pools;
+  };
+
   class Delegate {
    public:
     Delegate() {}
@@ -48,6 +129,20 @@ class URLRequestContextGetter : public net::URLRequestContextGetter {
     virtual std::string GetUserAgent();
     virtual std::unique_ptr<net::URLRequestJobFactory>
     CreateURLRequestJobFactory(content::ProtocolHandlerMap* protocol_handlers);
+    virtual HttpCacheOptions GetHttpCacheOptions();
+    // Reads the QUIC switches by default.
+    virtual QuicOptions GetQuicOptions();
+    // Called on the UI thread, returns nullptr to keep the server properties
+    // in memory.
+    virtual std::unique_ptr<net::HttpServerPropertiesManager>
+    CreateHttpServerPropertiesManager();
+    // Called on the UI thread, returns nullptr to start with an empty host
+    // cache every time. Not called when the host resolver is shared.
+    virtual std::unique_ptr<HostCachePersister> CreateHostCachePersister();
+    // Called on the UI thread, the default manager learns nothing.
+    virtual std::unique_ptr<PreconnectManager> CreatePreconnectManager();
+    // Called on the UI thread, shares nothing by default.
+    virtual SharedNetworkSession GetSharedNetworkSession();
     virtual net::HttpCache::BackendFactory* CreateHttpCacheBackendFactory(
         const base::FilePath& base_path);
     virtual std::unique_ptr<net::CertVerifier> CreateCertVerifier();
@@ -79,11 +174,37 @@ class URLRequestContextGetter : public net::URLRequestContextGetter {
 
   net::HostResolver* host_resolver();
   net::URLRequestJobFactory* job_factory() const { return job_factory_; }
+
+  // Called on the UI thread once the getter is referenced. The known CT logs
+  // are parsed once per process on a worker thread, then the context is
+  // created on the IO thread so that the cookie database and the cache
+  // backend start loading before the first request. A request coming first
+  // creates the context and parses the logs by itself.
+  void StartParsingCTLogs();
+
+  // Called on the IO thread.
+  HttpCacheStats GetHttpCacheStats() const;
+  // Called on the IO thread.
+  StartupTimings GetStartupTimings() const;
+  // Called on the IO thread, resolves |hosts| in the background so that the
+  // next requests to them find their addresses in the host cache.
+  void PrefetchDNS(const std::vector<std::string>& hosts);
+  // Called on the IO thread, opens |num_sockets| connections to the origin of
+  // |url| ahead of the requests to it.
+  void Preconnect(const GURL& url, int num_sockets);
   MediaDeviceIDSalt* GetMediaDeviceIDSalt() const {
     return delegate_->GetMediaDeviceIDSalt();
   }
 
  private:
+  class PrefetchRequest;
+
+  // Called on the IO thread.
+  void CreateContextOnceCTLogsParsed();
+  void OnCacheBackendReady(int result);
+  void OnCookiesLoaded(const net::CookieList& cookies);
+  void OnPrefetchDone(PrefetchRequest* request, int result);
+
   Delegate* delegate_;
 
   DevToolsNetworkControllerHandle* network_controller_handle_;
@@ -92,21 +213,46 @@ class URLRequestContextGetter : public net::URLRequestContextGetter {
   bool in_memory_;
   scoped_refptr<base::SingleThreadTaskRunner> io_task_runner_;
   scoped_refptr<base::SingleThreadTaskRunner> file_task_runner_;
+  // Keeps the components of the owner alive until |url_request_context_| is
+  // destroyed.
+  SharedNetworkSession shared_session_;
 
   std::string user_agent_;
 
   std::unique_ptr<net::ProxyConfigService> proxy_config_service_;
+  // Outlives |network_delegate_| which records the origins in it.
+  std::unique_ptr<PreconnectManager> preconnect_manager_;
   std::unique_ptr<net::NetworkDelegate> network_delegate_;
   std::unique_ptr<net::URLRequestContextStorage> storage_;
   std::unique_ptr<net::URLRequestContext> url_request_context_;
   std::unique_ptr<net::HostMappingRules> host_mapping_rules_;
   std::unique_ptr<net::HttpAuthPreferences> http_auth_preferences_;
   std::unique_ptr<net::HttpNetworkSession> http_network_session_;
+  // Handed to |storage_| once the context is created.
+  std::unique_ptr<net::HttpServerPropertiesManager>
+      http_server_properties_manager_;
+  // Initialized with the host cache once the context is created.
+  std::unique_ptr<HostCachePersister> host_cache_persister_;
+  // Pending prefetches, destroyed before the host resolver they wait on.
+  std::map<PrefetchRequest*, std::unique_ptr<PrefetchRequest>>
+      prefetch_requests_;
   content::ProtocolHandlerMap protocol_handlers_;
   content::URLRequestInterceptorScopedVector protocol_interceptors_;
 
   net::URLRequestJobFactory* job_factory_;  // weak ref
 
+  // Set when the disk cache backend is opened.
+  disk_cache::Backend* cache_backend_;  // weak ref
+
+  base::TimeTicks created_time_;
+  base::TimeTicks context_created_time_;
+  base::TimeTicks cache_backend_ready_time_;
+  base::TimeTicks cookies_loaded_time_;
+
+  // Transactions created above and under the HTTP cache.
+  HttpTransactionCounter* request_counter_;  // weak ref
+  HttpTransactionCounter* network_counter_;  // weak ref
+
   DISALLOW_COPY_AND_ASSIGN(URLRequestContextGetter);
 };
 
@@ -53,6 +53,35 @@ const char kAuthNegotiateDelegateWhitelist[] =
 // Ignores certificate-related errors.
 const char kIgnoreCertificateErrors[] = "ignore-certificate-errors";
 
+// Enables the QUIC protocol, servers then advertise it through Alt-Svc.
+const char kEnableQuic[] = "enable-quic";
+
+// Version of QUIC to use, like "QUIC_VERSION_35".
+const char kQuicVersion[] = "quic-version";
+
+// Comma-separated list of QUIC connection options, like "TBBR,1RTT".
+const char kQuicConnectionOptions[] = "quic-connection-options";
+
+// Comma-separated list of host:port origins always reached over QUIC, which
+// is how a local QUIC test server gets used. Implies --enable-quic.
+const char kOriginToForceQuicOn[] = "origin-to-force-quic-on";
+
+// Runs DevTools network emulation in virtual time, throttled transfers then
+// complete without waiting for the emulated latency and bandwidth.
+const char kDevToolsNetworkVirtualTime[] = "devtools-network-virtual-time";
+
+// Path of a JSON file of named DevTools network emulation presets, which are
+// added to the built-in ones.
+const char kDevToolsNetworkPresets[] = "devtools-network-presets";
+
+// Keeps the last megabytes of net log events in memory, which are written to
+// a file on demand.
+const char kNetLogRingBufferSize[] = "net-log-ring-buffer-size";
+
+// Drops the net log events kept in memory after this many seconds, five
+// minutes by default.
+const char kNetLogRingBufferSeconds[] = "net-log-ring-buffer-seconds";
+
 }  // namespace switches
 
 }  // namespace brightray
@@ -18,6 +18,14 @@ extern const char kDisableHttp2[];
 extern const char kAuthServerWhitelist[];
 extern const char kAuthNegotiateDelegateWhitelist[];
 extern const char kIgnoreCertificateErrors[];
+extern const char kEnableQuic[];
+extern const char kQuicVersion[];
+extern const char kQuicConnectionOptions[];
+extern const char kOriginToForceQuicOn[];
+extern const char kDevToolsNetworkVirtualTime[];
+extern const char kDevToolsNetworkPresets[];
+extern const char kNetLogRingBufferSize[];
+extern const char kNetLogRingBufferSeconds[];
 
 }  // namespace switches
 